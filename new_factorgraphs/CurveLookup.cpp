@@ -0,0 +1,159 @@
+#include <math.h>
+#include "CurveLookup.h"
+using namespace std;
+using namespace arma;
+
+#define MAX_CURVE_BUCKETS 4096
+#define CURVE_BLOCK_SIZE 256 // speeds interpolated at a time by the batch interpolate
+
+CurveLookup::CurveLookup(){
+
+	this->first = 0.0;
+	this->last = -1.0; // empty, everything is outside
+	this->bucketWidth = 1.0;
+	this->outside = 0.0;
+	this->maxSteps = 0;
+}
+
+void CurveLookup::build (const arma::mat &table, double outside){
+
+	unsigned n = table.n_rows;
+
+	this->outside = outside;
+	this->speeds.resize(n);
+	this->values.resize(n);
+	for (unsigned i = 0; i < n; i++) {
+		speeds[i] = table(i, 0);
+		values[i] = table(i, 1);
+	}
+
+	this->bucket.assign(1, 0);
+	this->maxSteps = 0;
+
+	if (n < 2) {
+		this->first = 0.0;
+		this->last = -1.0;
+		return;
+	}
+
+	// the buckets are as wide as the narrowest interval (unless there would be too many)
+	double narrowest = 0.0;
+	bool sorted = true;
+	for (unsigned i = 0; i + 1 < n; i++) {
+		double width = speeds[i + 1] - speeds[i];
+		if (width < 0)
+			sorted = false;
+		else if (width > 0 && (narrowest == 0.0 || width < narrowest))
+			narrowest = width;
+	}
+
+	if (!sorted || narrowest == 0.0) {
+		// a single bucket holding the whole table, i.e. the plain scan
+		this->first = -HUGE_VAL;
+		this->last = HUGE_VAL;
+		this->bucketWidth = HUGE_VAL;
+		return;
+	}
+
+	this->first = speeds[0];
+	this->last = speeds[n - 1];
+
+	unsigned numBuckets = (unsigned) ceil((last - first) / narrowest);
+	if (numBuckets < 1)
+		numBuckets = 1;
+	if (numBuckets > MAX_CURVE_BUCKETS)
+		numBuckets = MAX_CURVE_BUCKETS;
+	this->bucketWidth = (last - first) / numBuckets;
+
+	// bucket b starts with the first interval reaching into bucket b-1 (a bucket of slack
+	// for a speed rounded into the next bucket)
+	this->bucket.resize(numBuckets);
+	unsigned i = 0;
+	for (unsigned b = 0; b < numBuckets; b++) {
+		double start = first + ((double) b - 1) * bucketWidth;
+		while (i + 2 < n && speeds[i + 1] < start)
+			i++;
+		bucket[b] = i;
+	}
+
+	// a speed rounded into bucket b is below the end of bucket b+1
+	for (unsigned b = 0; b < numBuckets; b++) {
+		double end = first + ((double) b + 2) * bucketWidth;
+		unsigned j = bucket[b];
+		while (j + 2 < n && speeds[j + 1] < end)
+			j++;
+		if (j - bucket[b] > maxSteps)
+			maxSteps = j - bucket[b];
+	}
+}
+
+//Calculate Functions
+double CurveLookup::interpolate (double v) const{
+
+	if (!(first <= v && v <= last))
+		return outside;
+
+	unsigned b = 0;
+	if (bucket.size() > 1) {
+		b = (unsigned) ((v - first) / bucketWidth);
+		if (b >= bucket.size())
+			b = bucket.size() - 1;
+	}
+
+	for (unsigned i = bucket[b]; i + 1 < speeds.size(); i++)
+		if (speeds[i] <= v && v <= speeds[i + 1])
+			return values[i]
+					+ (values[i + 1] - values[i]) * (v - speeds[i])
+							/ (speeds[i + 1] - speeds[i]); // linear interpolation
+
+	return outside;
+}
+
+// the values at the n speeds v (all the effective speeds of a direction at once); a block of
+// speeds at a time, each pass over the block is a loop without branches: the speeds outside
+// are replaced by a speed inside, the intervals are found by the same number of steps for
+// all the speeds (they stop at the first interval reaching up to the speed, just like the
+// scan), and the speeds outside get their value at the very end
+void CurveLookup::interpolate (const double *v, double *result, unsigned n) const{
+
+	// an empty or unsorted table has got no buckets to step through
+	if (speeds.size() < 2 || bucketWidth == HUGE_VAL) {
+		for (unsigned k = 0; k < n; k++)
+			result[k] = interpolate(v[k]);
+		return;
+	}
+
+	const double *s = &speeds[0];
+	const double *y = &values[0];
+	const unsigned *firstInterval = &bucket[0];
+	int lastBucket = bucket.size() - 1;
+	int lastInterval = speeds.size() - 2;
+	double lo = first, hi = last, width = bucketWidth, out = outside; // not read again after every store
+
+	double x[CURVE_BLOCK_SIZE];
+	int interval[CURVE_BLOCK_SIZE];
+
+	for (unsigned start = 0; start < n; start += CURVE_BLOCK_SIZE) {
+		int size = (n - start < CURVE_BLOCK_SIZE) ? n - start : CURVE_BLOCK_SIZE;
+		const double *vb = v + start;
+		double *rb = result + start;
+
+		for (int k = 0; k < size; k++) {
+			x[k] = ((lo <= vb[k]) & (vb[k] <= hi)) ? vb[k] : lo;
+			int b = (int) ((x[k] - lo) / width);
+			interval[k] = firstInterval[(b < lastBucket) ? b : lastBucket];
+		}
+
+		for (unsigned step = 0; step < maxSteps; step++)
+			for (int k = 0; k < size; k++)
+				interval[k] += (interval[k] < lastInterval) & (s[interval[k] + 1] < x[k]);
+
+		for (int k = 0; k < size; k++) {
+			int i = interval[k];
+			x[k] = y[i] + (y[i + 1] - y[i]) * (x[k] - s[i]) / (s[i + 1] - s[i]); // linear interpolation
+		}
+
+		for (int k = 0; k < size; k++)
+			rb[k] = ((lo <= vb[k]) & (vb[k] <= hi)) ? x[k] : out;
+	}
+}
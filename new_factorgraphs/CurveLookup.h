@@ -0,0 +1,42 @@
+#ifndef __CURVELOOKUP_H_INCLUDED__
+#define __CURVELOOKUP_H_INCLUDED__
+
+#include <vector>
+#include "armadillo"
+
+using namespace std;
+using namespace arma;
+
+// A piecewise linear curve (a power or thrust curve of a turbine) given by a table with the
+// wind speeds in column 0 and the values in column 1. The speeds are cut into buckets of the
+// same width, each of which knows the first interval of the table reaching into it, so a
+// lookup takes a division and a step or two instead of a scan of the whole table. The value
+// is interpolated exactly as by the scan (the same interval, the same operations), so the
+// results do not change; outside the table the curve is the given constant. The batch
+// interpolate does the same without branches: every speed takes the same number of steps
+// (the most any bucket needs) and the speeds outside the table are masked at the end, so
+// its loops can be vectorized where the target has gathers (e.g. with -mavx2).
+
+class CurveLookup {
+
+	public:
+		std::vector<double> speeds;
+		std::vector<double> values;
+		std::vector<unsigned> bucket; //first interval reaching into each bucket
+		double first;
+		double last;
+		double bucketWidth;
+		double outside; //value outside the table
+		unsigned maxSteps; //most steps from the first interval of a bucket to the one of a speed in it
+
+	CurveLookup();
+
+	void build (const arma::mat &table, double outside);
+
+	//Calculate Functions
+	double interpolate (double v) const;
+	void interpolate (const double *v, double *result, unsigned n) const;
+
+};
+
+#endif
@@ -0,0 +1,335 @@
+#include "IncrementalLayoutEvaluator.h"
+using namespace std;
+using namespace arma;
+
+IncrementalLayoutEvaluator::IncrementalLayoutEvaluator(const WindFarmLayout *layout, int numSites, int gridColumns, double spacing, const WakeInteractionTable *table){
+
+	this->layout = layout;
+	this->table = table;
+	this->numSites = numSites;
+	this->gridColumns = gridColumns;
+	this->spacing = spacing;
+	this->numDirections = layout->windDirections.n_elem;
+	this->numSpeeds = layout->windSpeeds.n_cols;
+	this->useTable = false;
+	this->numT = 0;
+	this->totalPower = 0.0;
+	this->farmEfficiency = 0.0;
+	this->AEP = 0.0;
+
+	// the directions in the frame of the grid
+	this->cosTheta = arma::zeros<vec>(numDirections);
+	this->sinTheta = arma::zeros<vec>(numDirections);
+	for (unsigned w = 0; w < numDirections; w++) {
+		cosTheta(w) = cos(layout->windDirections(w));
+		sinTheta(w) = sin(layout->windDirections(w));
+	}
+
+	// the wake-free power of a turbine, the bins dropped from the wind rose included
+	this->upperboundPerTurbine = layout->droppedFreePower;
+	for (unsigned w = 0; w < numDirections; w++)
+		for (unsigned l = 0; l < layout->binsPerDirection[w]; l++)
+			this->upperboundPerTurbine += layout->binFreePower(l, w);
+}
+
+//GET Functions
+// the turbine standing on the site, -1 if the site is free
+int IncrementalLayoutEvaluator::findTurbine (int site) const{
+	for (unsigned i = 0; i < numT; i++)
+		if (sites[i] == site)
+			return i;
+
+	return -1;
+}
+
+// a turbine of the layout may only move to a free site of the grid
+bool IncrementalLayoutEvaluator::isValidMove (unsigned turbine, int newSite) const{
+	return (turbine < numT) && (newSite >= 0) && (newSite < numSites) && (findTurbine(newSite) < 0);
+}
+
+// The table holds the pairs of turbine 0 with the wake radius independent of Ct, so it
+// only stands in for the wake geometry when all the turbines are alike.
+bool IncrementalLayoutEvaluator::tableFits () const{
+#ifdef CT_DEPENDENT
+	return false;
+#else
+	if (table == NULL || table->layout != layout || table->gridColumns != gridColumns || table->spacing != spacing || table->numSites < numSites)
+		return false;
+
+	for (unsigned i = 1; i < numT; i++)
+		if (layout->DRot(i) != layout->DRot(0) || layout->wakeSpread(i) != layout->wakeSpread(0))
+			return false;
+
+	return true;
+#endif
+}
+
+// Squared deficits that the turbine source on sourceSite causes on the turbine receiver on
+// receiverSite in the speed bins of direction w, put in binSqr; the same geometry and
+// deficits as computeWakeGeometry and accumulateWakeDeficits for this single pair (a bin
+// with a zero deficit is one the receiver is not in the wake in). Returns false (and leaves
+// binSqr alone) if the receiver is not in the wake in any bin.
+bool IncrementalLayoutEvaluator::pairDeficitSqrs (unsigned w, unsigned receiver, int receiverSite, unsigned source, int sourceSite, double *binSqr) const{
+
+	unsigned numBins = layout->binsPerDirection[w];
+
+	if (useTable) {
+		double d = table->deficitSqr(table->getIndex(w, receiverSite, sourceSite));
+		if (d == 0)
+			return false;
+
+		for (unsigned l = 0; l < numBins; l++)
+			binSqr[l] = table->inductionSqr(w, l) * d;
+
+		return true;
+	}
+
+	double dx = (receiverSite / gridColumns) * spacing - (sourceSite / gridColumns) * spacing;
+	double dy = (receiverSite % gridColumns) * spacing - (sourceSite % gridColumns) * spacing;
+	double du = dx * cosTheta(w) + dy * sinTheta(w); // down the wind
+	double dv = dy * cosTheta(w) - dx * sinTheta(w); // across the wind
+
+	if (du <= 0) // turbines side by side do not shade each other
+		return false;
+
+	double r0i = layout->DRot(receiver) / 2;
+	double r0j = layout->DRot(source) / 2;
+	double alpha = layout->wakeSpread(source);
+
+#ifdef CT_DEPENDENT
+	// the wake radius, and so the overlap, changes with the bin
+	bool inWake = false;
+
+	for (unsigned l = 0; l < numBins; l++) {
+		double a = layout->binInduction(l, w);
+		double r = layout->wakeRadius(r0j, a);
+		double overlap = layout->rotorOverlap(dv, r0i, r + alpha * du);
+
+		double deficit = a * pow(r / (r + alpha * du), 2.0) * overlap;
+		binSqr[l] = pow(deficit, 2);
+		if (overlap != 0)
+			inWake = true;
+	}
+
+	return inWake;
+#else
+	double r = layout->wakeRadius(r0j, 0.0);
+	double overlap = layout->rotorOverlap(dv, r0i, r + alpha * du);
+	if (overlap == 0)
+		return false;
+
+	double shrink = pow(r / (r + alpha * du), 2.0);
+	for (unsigned l = 0; l < numBins; l++) {
+		double deficit = layout->binInduction(l, w) * shrink * overlap;
+		binSqr[l] = deficit * deficit;
+	}
+
+	return true;
+#endif
+}
+
+// probability-weighted power of a turbine over the speed bins of direction w, sumSqr holding
+// its sums of squared deficits of the bins
+double IncrementalLayoutEvaluator::directionPower (unsigned w, const double *sumSqr) const{
+	double power = 0.0;
+
+	for (unsigned l = 0; l < layout->binsPerDirection[w]; l++) {
+		double effSpeed = layout->windSpeeds(w, l) * (1 - sqrt(sumSqr[l]));
+		power += layout->getPower(effSpeed) * layout->windProb(w, l);
+	}
+
+	return power;
+}
+
+void IncrementalLayoutEvaluator::updateResults (){
+	// summed again from the stored terms, so that rounding errors of the moves do not pile up
+	this->totalPower = 0.0;
+	for (unsigned w = 0; w < numDirections; w++)
+		for (unsigned i = 0; i < numT; i++)
+			this->totalPower += turbinePower(w, i);
+
+	this->AEP = totalPower * 8766 / 1000000;
+	this->farmEfficiency = totalPower / (numT * upperboundPerTurbine);
+}
+
+//Calculate Functions
+// Evaluates the layout from scratch the way evaluateLayout does and keeps its state for the
+// moves that follow. Returns -1 (and keeps the previous state) if a site is off the grid or
+// taken twice, or if the wind farm has the data of fewer than numT turbines.
+double IncrementalLayoutEvaluator::setLayout (const int *sites, unsigned numT){
+
+	if (numT == 0 || numT > layout->DRot.n_elem || numT > layout->wakeSpread.n_elem)
+		return -1;
+
+	for (unsigned i = 0; i < numT; i++) {
+		if (sites[i] < 0 || sites[i] >= numSites)
+			return -1;
+		for (unsigned j = 0; j < i; j++)
+			if (sites[j] == sites[i])
+				return -1;
+	}
+
+	this->numT = numT;
+	this->sites.assign(sites, sites + numT);
+	this->useTable = tableFits();
+
+	arma::vec coordinates(2 * numT);
+	for (unsigned i = 0; i < numT; i++) {
+		coordinates(i) = (sites[i] / gridColumns) * spacing;
+		coordinates(i + numT) = (sites[i] % gridColumns) * spacing;
+	}
+
+	mat overlap(numT, numT);
+	mat distance(numT, numT);
+	vec shrink(numT); // work buffers of the deficit kernel
+	vec sourceOverlap(numT);
+
+	this->defSumSqr.assign(numDirections, arma::zeros<mat>(numSpeeds, numT));
+	this->numWakes.assign(numDirections * numT * numSpeeds, 0);
+	this->turbinePower = arma::zeros<mat>(numDirections, numT);
+
+	for (unsigned w = 0; w < numDirections; w++) {
+		double theta = layout->windDirections(w);
+		unsigned numBins = layout->binsPerDirection[w];
+
+#ifdef CT_DEPENDENT
+		for (unsigned l = 0; l < numBins; l++) {
+			layout->computeWakeGeometry(coordinates, theta, layout->binInduction(l, w), overlap, distance);
+			layout->accumulateWakeDeficits(overlap, distance, w, l, l + 1, defSumSqr[w]);
+			countWakes(w, l, l + 1, overlap);
+		}
+#else
+		layout->computeWakeGeometry(coordinates, theta, 0.0, overlap, distance);
+		layout->accumulateWakeDeficitsAllBins(overlap, distance, layout->binInduction.memptr() + w * layout->binInduction.n_rows, numBins, shrink.memptr(), sourceOverlap.memptr(), defSumSqr[w]);
+		countWakes(w, 0, numBins, overlap);
+#endif
+
+		for (unsigned i = 0; i < numT; i++)
+			turbinePower(w, i) = directionPower(w, defSumSqr[w].memptr() + i * defSumSqr[w].n_rows);
+	}
+
+	updateResults();
+
+	return ((this->farmEfficiency)*100);
+}
+
+// Counts the wakes each turbine is in for the bins firstBin..lastBin-1 of direction w, the
+// overlaps being those of the bins (a bin with no induction has no deficits, so no wakes).
+void IncrementalLayoutEvaluator::countWakes (unsigned w, unsigned firstBin, unsigned lastBin, const arma::mat &overlap){
+	for (unsigned i = 0; i < numT; i++)
+		for (unsigned j = 0; j < numT; j++)
+			if (j != i && overlap(i, j) != 0)
+				for (unsigned l = firstBin; l < lastBin; l++)
+					if (layout->binInduction(l, w) != 0)
+						numWakes[(w * numT + i) * numSpeeds + l]++;
+}
+
+// Change of the total power when a turbine moves to a free site; only the terms of the pairs
+// with the moved turbine are touched. The changed sums, powers and numbers of wakes are
+// written to newSumSqrs, newPowers and newNumWakes unless they are NULL (they may be the
+// stored ones). A sum of a turbine left in no wake is set to 0, as what is left of it after
+// taking the wakes away is only rounding (and its square root would be taken for a deficit).
+double IncrementalLayoutEvaluator::moveDelta (unsigned turbine, int newSite, std::vector<arma::mat> *newSumSqrs, arma::mat *newPowers, std::vector<unsigned> *newNumWakes) const{
+
+	double delta = 0.0;
+	int oldSite = sites[turbine];
+
+	std::vector<unsigned> wakes(numSpeeds);
+	vec sumSqr(numSpeeds);
+	vec newSqr(numSpeeds); // deficits of the pair with the moved turbine on its new site
+	vec oldSqr(numSpeeds); // and on its old one
+
+	for (unsigned w = 0; w < numDirections; w++) {
+		unsigned numBins = layout->binsPerDirection[w];
+
+		// the moved turbine gets all its deficits anew
+		for (unsigned l = 0; l < numBins; l++) {
+			sumSqr(l) = 0.0;
+			wakes[l] = 0;
+		}
+
+		for (unsigned j = 0; j < numT; j++)
+			if (j != turbine && pairDeficitSqrs(w, turbine, newSite, j, sites[j], newSqr.memptr()))
+				for (unsigned l = 0; l < numBins; l++) {
+					sumSqr(l) += newSqr(l);
+					wakes[l] += (newSqr(l) != 0);
+				}
+
+		double power = directionPower(w, sumSqr.memptr());
+		delta += power - turbinePower(w, turbine);
+		if (newSumSqrs) {
+			for (unsigned l = 0; l < numBins; l++) {
+				(*newSumSqrs)[w](l, turbine) = sumSqr(l);
+				(*newNumWakes)[(w * numT + turbine) * numSpeeds + l] = wakes[l];
+			}
+			(*newPowers)(w, turbine) = power;
+		}
+
+		// the others lose the wake of the old site and get that of the new one
+		for (unsigned i = 0; i < numT; i++) {
+			if (i == turbine)
+				continue;
+
+			bool inNewWake = pairDeficitSqrs(w, i, sites[i], turbine, newSite, newSqr.memptr());
+			bool inOldWake = pairDeficitSqrs(w, i, sites[i], turbine, oldSite, oldSqr.memptr());
+			if (!inNewWake && !inOldWake)
+				continue;
+
+			for (unsigned l = 0; l < numBins; l++) {
+				double newSumSqr = defSumSqr[w](l, i);
+				wakes[l] = numWakes[(w * numT + i) * numSpeeds + l];
+				if (inNewWake) {
+					newSumSqr += newSqr(l);
+					wakes[l] += (newSqr(l) != 0);
+				}
+				if (inOldWake) {
+					newSumSqr -= oldSqr(l);
+					wakes[l] -= (oldSqr(l) != 0);
+				}
+				sumSqr(l) = (wakes[l] == 0 || newSumSqr < 0)? 0 : newSumSqr;
+			}
+
+			power = directionPower(w, sumSqr.memptr());
+			delta += power - turbinePower(w, i);
+			if (newSumSqrs) {
+				for (unsigned l = 0; l < numBins; l++) {
+					(*newSumSqrs)[w](l, i) = sumSqr(l);
+					(*newNumWakes)[(w * numT + i) * numSpeeds + l] = wakes[l];
+				}
+				(*newPowers)(w, i) = power;
+			}
+		}
+	}
+
+	return delta;
+}
+
+// Efficiency (in %) of the layout with the turbine moved to newSite, the stored layout is
+// left as it is. The AEP of the moved layout is put in newAEP unless it is NULL. Returns -1
+// if the move is not valid (see isValidMove).
+double IncrementalLayoutEvaluator::evaluateMove (unsigned turbine, int newSite, double *newAEP) const{
+
+	if (!isValidMove(turbine, newSite))
+		return -1;
+
+	double power = totalPower + moveDelta(turbine, newSite, NULL, NULL, NULL);
+
+	if (newAEP)
+		*newAEP = power * 8766 / 1000000;
+
+	return (power / (numT * upperboundPerTurbine)) * 100;
+}
+
+// Moves the turbine to newSite and returns the efficiency (in %) of the new layout, or -1
+// (leaving the layout as it is) if the move is not valid (see isValidMove).
+double IncrementalLayoutEvaluator::applyMove (unsigned turbine, int newSite){
+
+	if (!isValidMove(turbine, newSite))
+		return -1;
+
+	moveDelta(turbine, newSite, &defSumSqr, &turbinePower, &numWakes);
+	sites[turbine] = newSite;
+	updateResults();
+
+	return ((this->farmEfficiency)*100);
+}
@@ -0,0 +1,69 @@
+#ifndef __INCREMENTALLAYOUTEVALUATOR_H_INCLUDED__
+#define __INCREMENTALLAYOUTEVALUATOR_H_INCLUDED__
+
+#include <vector>
+#include "WindFarmLayout.h"
+#include "WakeInteractionTable.h"
+#include "armadillo"
+
+using namespace std;
+using namespace arma;
+
+// Keeps the state of an evaluated layout on a regular siting grid so that moving a single
+// turbine to a free site is evaluated without redoing the whole farm. Site s sits at
+// ((s / gridColumns) * spacing, (s % gridColumns) * spacing), like in WakeInteractionTable.
+// For every direction it stores the sum of squared deficits of each turbine in each speed
+// bin (as evaluateLayout computes them) and the probability-weighted power of each turbine
+// summed over the bins. A move changes only the pairs that involve the moved turbine, so it
+// costs the wake geometry of O(numT) pairs per direction plus the power of the turbines
+// whose deficits really changed. The turbines may differ and the wake radius may depend on
+// Ct (CT_DEPENDENT). A WakeInteractionTable of the same grid may be given to look the pairs
+// up instead; it is only used when it fits (identical turbines, no CT_DEPENDENT).
+
+class IncrementalLayoutEvaluator {
+
+	public:
+		const WindFarmLayout *layout;
+		const WakeInteractionTable *table; //fast path for the pairs, NULL if there is none
+		int numSites;
+		int gridColumns;
+		double spacing;
+		unsigned numDirections;
+		unsigned numSpeeds;
+		arma::vec cosTheta; //cos of each wind direction
+		arma::vec sinTheta; //sin of each wind direction
+		bool useTable; //whether the pairs of the current layout are looked up in the table
+
+		unsigned numT;
+		std::vector<int> sites; //site of each turbine
+		std::vector<arma::mat> defSumSqr; //sum of the sqr of deficits for each direction, bin l of turbine i in (l, i)
+		std::vector<unsigned> numWakes; //number of wakes each turbine is in, bin l of turbine i in direction w at (w * numT + i) * numSpeeds + l
+		arma::mat turbinePower; //power of each (direction, turbine), weighted by the bin probabilities
+		double upperboundPerTurbine; //wake-free power of a single turbine
+		double totalPower;
+
+		double farmEfficiency;
+		double AEP;
+
+	IncrementalLayoutEvaluator(const WindFarmLayout *layout, int numSites, int gridColumns, double spacing, const WakeInteractionTable *table);
+
+	//GET Functions
+	int findTurbine (int site) const;
+	bool isValidMove (unsigned turbine, int newSite) const;
+
+	//Calculate Functions
+	double setLayout (const int *sites, unsigned numT);
+	double evaluateMove (unsigned turbine, int newSite, double *newAEP) const;
+	double applyMove (unsigned turbine, int newSite);
+
+	private:
+		double directionPower (unsigned w, const double *sumSqr) const;
+		double moveDelta (unsigned turbine, int newSite, std::vector<arma::mat> *newSumSqrs, arma::mat *newPowers, std::vector<unsigned> *newNumWakes) const;
+		void countWakes (unsigned w, unsigned firstBin, unsigned lastBin, const arma::mat &overlap);
+		bool pairDeficitSqrs (unsigned w, unsigned receiver, int receiverSite, unsigned source, int sourceSite, double *binSqr) const;
+		bool tableFits () const;
+		void updateResults ();
+
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "WakeInteractionTable.h"
+using namespace std;
+using namespace arma;
+
+WakeInteractionTable::WakeInteractionTable(WindFarmLayout *layout, int numSites, int gridColumns, double spacing, int mode){
+
+	this->layout = layout;
+	this->mode = mode;
+	this->numSites = numSites;
+	this->gridColumns = gridColumns;
+	this->gridRows = (numSites + gridColumns - 1) / gridColumns;
+	this->spacing = spacing;
+	this->numDirections = layout->windDirections.n_elem;
+	this->numSpeeds = layout->windSpeeds.n_cols;
+
+	if (mode == TABLE_MODE_OFFSET)
+		this->entriesPerDirection = (2 * gridRows - 1) * (2 * gridColumns - 1);
+	else
+		this->entriesPerDirection = numSites * numSites;
+
+	this->overlap = arma::zeros<vec>(numDirections * entriesPerDirection);
+	this->distance = arma::zeros<vec>(numDirections * entriesPerDirection);
+	this->deficitSqr = arma::zeros<vec>(numDirections * entriesPerDirection);
+
+	// all turbines are like turbine 0
+	double r = layout->wakeRadius(layout->DRot(0) / 2, 0.0);
+	double alpha = layout->wakeSpread(0);
+
+	arma::vec pair(4); // receiver is turbine 0, source is turbine 1
+	arma::mat pairOverlap(2, 2);
+	arma::mat pairDistance(2, 2);
+
+	for (unsigned w = 0; w < numDirections; w++) {
+		double theta = layout->windDirections(w);
+
+		for (int receiver = 0; receiver < (int) entriesPerDirection; receiver++) {
+			unsigned idx = w * entriesPerDirection + receiver;
+
+			if (mode == TABLE_MODE_OFFSET) {
+				// entry receiver encodes the displacement of the receiver from the source
+				int dr = receiver / (2 * gridColumns - 1) - (gridRows - 1);
+				int dc = receiver % (2 * gridColumns - 1) - (gridColumns - 1);
+				if (dr == 0 && dc == 0)
+					continue;
+				pair(0) = dr * spacing;
+				pair(1) = 0;
+				pair(2) = dc * spacing;
+				pair(3) = 0;
+			}
+			else {
+				int a = receiver / numSites;
+				int b = receiver % numSites;
+				if (a == b)
+					continue;
+				pair(0) = (a / gridColumns) * spacing;
+				pair(1) = (b / gridColumns) * spacing;
+				pair(2) = (a % gridColumns) * spacing;
+				pair(3) = (b % gridColumns) * spacing;
+			}
+
+			layout->computeWakeGeometry(pair, theta, 0.0, pairOverlap, pairDistance);
+
+			this->overlap(idx) = pairOverlap(0, 1);
+			this->distance(idx) = pairDistance(0, 1);
+			if (pairOverlap(0, 1) > 0)
+				this->deficitSqr(idx) = pow(pairOverlap(0, 1) * pow(r / (r + alpha * pairDistance(0, 1)), 2.0), 2);
+		}
+	}
+
+	// the layout-independent parts of the deficit and of the wake-free power
+	this->inductionSqr = arma::zeros<mat>(numDirections, numSpeeds);
+	this->upperboundPerTurbine = 0.0;
+
+	for (unsigned w = 0; w < numDirections; w++)
+		for (unsigned l = 0; l < layout->binsPerDirection[w]; l++) {
+			double a = layout->binInduction(l, w);
+			this->inductionSqr(w, l) = a * a;
+			this->upperboundPerTurbine += layout->binFreePower(l, w);
+		}
+	this->upperboundPerTurbine += layout->droppedFreePower; // bins dropped from the wind rose
+
+	this->farmEfficiency = 0.0;
+	this->AEP = 0.0;
+}
+
+//GET Functions
+unsigned WakeInteractionTable::getIndex (unsigned w, int receiver, int source) const{
+	if (mode == TABLE_MODE_OFFSET) {
+		int dr = receiver / gridColumns - source / gridColumns;
+		int dc = receiver % gridColumns - source % gridColumns;
+		return w * entriesPerDirection + (dr + gridRows - 1) * (2 * gridColumns - 1) + (dc + gridColumns - 1);
+	}
+
+	return w * entriesPerDirection + receiver * numSites + source;
+}
+
+// memory used by the tables (in MB)
+double WakeInteractionTable::getTableSize () const{
+	return 3.0 * numDirections * entriesPerDirection * sizeof(double) / (1024 * 1024);
+}
+
+//Calculate Functions
+double WakeInteractionTable::calculateFarmPower (int *sites, unsigned numT){
+
+	FarmPowerResult result;
+
+	evaluateLayout(sites, numT, &result);
+
+	// Stores the results in this instance of the object
+	this->AEP = result.AEP;
+	this->farmEfficiency = result.farmEfficiency;
+
+	return ((this->farmEfficiency)*100);
+}
+
+// Evaluates the layout with turbines on the given sites; the results have the same meaning
+// as those of WindFarmLayout::evaluateLayout. With a Ct-independent wake radius the squared
+// deficit of j on i in bin l is a(l)^2 * deficitSqr(i, j), so each direction needs a
+// single sum of squares per turbine.
+double WakeInteractionTable::evaluateLayout (const int *sites, unsigned numT, FarmPowerResult *result) const{
+
+	double totalPower = 0.0;
+	arma::vec defSumSqr(numT); // sum of the sqr of deficits, to be scaled by the bin's induction
+
+	result->turbinePowers = arma::zeros<vec>(numT);
+	result->turbineEffectiveWindSpeeds = arma::zeros<vec>(numT);
+
+	for (unsigned w = 0; w < numDirections; w++) {
+
+		for (unsigned i = 0; i < numT; i++) {
+			defSumSqr(i) = 0;
+			for (unsigned j = 0; j < numT; j++)
+				if (j != i)
+					defSumSqr(i) += deficitSqr(getIndex(w, sites[i], sites[j]));
+		}
+
+		for (unsigned l = 0; l < layout->binsPerDirection[w]; l++) {
+			double v = layout->windSpeeds(w, l);
+			double p = layout->windProb(w, l);
+
+			for (unsigned i = 0; i < numT; i++) {
+				double effSpeed = v * (1 - sqrt(inductionSqr(w, l) * defSumSqr(i)));
+				double power = layout->getPower(effSpeed) * p;
+				totalPower += power;
+				result->turbinePowers(i) += power;
+				result->turbineEffectiveWindSpeeds(i) += effSpeed * p;
+			}
+		}
+	}
+
+	result->turbinePowers = result->turbinePowers * 8766 / 1000000;
+	result->AEP = totalPower * 8766 / 1000000;
+	result->farmEfficiency = totalPower / (numT * upperboundPerTurbine);
+
+	return ((result->farmEfficiency)*100);
+}
@@ -0,0 +1,54 @@
+#ifndef __WAKEINTERACTIONTABLE_H_INCLUDED__
+#define __WAKEINTERACTIONTABLE_H_INCLUDED__
+
+#include "WindFarmLayout.h"
+#include "armadillo"
+
+#define TABLE_MODE_SITES  1 // one entry per (site, site, direction)
+#define TABLE_MODE_OFFSET 2 // one entry per (grid displacement, direction)
+
+using namespace std;
+using namespace arma;
+
+// Precomputed wake interactions between the sites of a regular siting grid. Site s sits
+// at ((s / gridColumns) * spacing, (s % gridColumns) * spacing); every turbine pair of a
+// layout on this grid is one of the tabulated site pairs, so a layout is evaluated by
+// table lookups and a sum-of-squares reduction instead of wake geometry.
+// All turbines are assumed to share the rotor diameter, height and roughness length of
+// turbine 0, and the wake radius must not depend on Ct (no CT_DEPENDENT).
+
+class WakeInteractionTable {
+
+	public:
+		WindFarmLayout *layout;
+		int mode;
+		int numSites;
+		int gridRows;
+		int gridColumns;
+		double spacing;
+		unsigned numDirections;
+		unsigned numSpeeds;
+		unsigned entriesPerDirection;
+
+		arma::vec overlap; //fraction of the receiving rotor in the wake of the source
+		arma::vec distance; //stream-wise distance from the source to the receiver
+		arma::vec deficitSqr; //(overlap * (r / (r + alpha * distance))^2)^2, 0 when not in the wake
+		arma::mat inductionSqr; //squared axial induction for each (direction, speed bin)
+		double upperboundPerTurbine; //wake-free power of a single turbine
+
+		double farmEfficiency;
+		double AEP;
+
+	WakeInteractionTable(WindFarmLayout *layout, int numSites, int gridColumns, double spacing, int mode);
+
+	//GET Functions
+	unsigned getIndex (unsigned w, int receiver, int source) const;
+	double getTableSize () const;
+
+	//Calculate Functions
+	double calculateFarmPower (int *sites, unsigned numT);
+	double evaluateLayout (const int *sites, unsigned numT, FarmPowerResult *result) const;
+
+};
+
+#endif
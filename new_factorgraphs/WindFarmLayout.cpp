@@ -1,4 +1,6 @@
 #include "WindFarmLayout.h"
+#include "deficitKernel.h"
+#include <algorithm>
 using namespace std;
 using namespace arma; 
 
@@ -50,9 +52,9 @@ WindFarmLayout::WindFarmLayout(const char *wind_farm_layout_file_path, const cha
 
 	this->AEP = 0.0;
 	this->SPL = 0.0;
+	this->overlapMode = WAKE_OVERLAP_SAMPLED;
 
 	validate();
-
 }
 
 /*	const char *layout_file;
@@ -78,6 +80,10 @@ void WindFarmLayout::setWindResourceFile (const char *wind_resource_file_path){
 	this->wind_resource_file_path = wind_resource_file_path;
 }
 
+void WindFarmLayout::setOverlapMode (int overlapMode){
+	this->overlapMode = overlapMode;
+}
+
 //READ Functions
 void WindFarmLayout::readWindFarmLayoutFile (){
 	std::ifstream f_in;
@@ -161,8 +167,25 @@ arma::mat WindFarmLayout::getConstraintsCoordinates(){
 	return  constraints_coordinates;
 }	
 
-//Calculate Function
+//Calculate Functions
 double WindFarmLayout::calculateFarmPower (arma::vec someTurbineCoordinates){
+
+	FarmPowerResult result;
+
+	evaluateLayout(someTurbineCoordinates, &result);
+
+	// Stores the results in this instance of the object
+	this->turbineEffectiveWindSpeeds = result.turbineEffectiveWindSpeeds;
+	this->turbinePowers = result.turbinePowers;
+	this->AEP = result.AEP;
+	this->farmEfficiency = result.farmEfficiency;
+
+	return ((this->farmEfficiency)*100);
+}
+
+// Same as calculateFarmPower, but leaves this object untouched and returns the results in
+// result instead, so it can be called from several threads at once
+double WindFarmLayout::evaluateLayout (const arma::vec &someTurbineCoordinates, FarmPowerResult *result) const{
 //initialization
 	unsigned numT = someTurbineCoordinates.n_elem / 2;
 	double totalPower = 0.0;
@@ -178,168 +201,50 @@ double WindFarmLayout::calculateFarmPower (arma::vec someTurbineCoordinates){
 	mat tEffSpeed = zeros<mat>(numT, this->windDirections.n_elem);
 	mat effPower = zeros<mat>(numT, this->windDirections.n_elem);
 
+	mat overlap(numT, numT); // fraction of the rotor of i that lies in the wake of j (0 if i is not in the wake of j)
+	mat distance(numT, numT); // stream-wise distance from j to i
+	vec shrink(numT); // work buffers of the deficit kernel
+	vec sourceOverlap(numT);
+
+	mat effSpeed(numT, windSpeeds.n_cols); //stores final effective wind speed at i
+	mat effSpeedPower(numT, windSpeeds.n_cols); //power of a turbine at its effective wind speed
+	mat defSumSqr(windSpeeds.n_cols, numT); // sum of the sqr of deficits (0~1) from multiple wakes, bin l of turbine i in (l, i)
+
 	for (unsigned w = 0; w < windDirections.n_elem; w++) // each wind direction has one ROW in windSpeeds and windProb
 			{
 		double theta = windDirections(w);
+		unsigned numBins = binsPerDirection[w]; // the rest have been dropped from the wind rose
 
-		cube downstream = ones(numT, numT, windSpeeds.n_cols) * -1; //1 if i is in downstream of j, 0 otherwise, -1 if not initialized
+		defSumSqr.zeros();
 
-		cube overlap = zeros(numT, numT, windSpeeds.n_cols); // 1 if i is downstream and completely in the wake of j; 0 if i is not in the wake of j
-
-		for (unsigned i = 0; i < numT; i++) {
-			// dromero
-			// use a turbine-specific rotor diameter
-			double r0i = this->DRot(i) / 2;
-
-			for (unsigned j = 0; j < numT; j++) {
-				// dromero
-				// calculates wake expansion angle based on this turbine's height
-				double alpha = 0.5 / log(this->Z(j) / this->Z0(j));
-				// use a turbine-specific rotor diameter
-				double r0j = this->DRot(j) / 2;
-
-				for (unsigned l = 0; l < windSpeeds.n_cols; l++) {
-					if (downstream(i, j, l) == -1) //not already initialized
-							{
-						/*
-						 \      /
-						 \  * /<-- centre of turbine i
-						 \__/ <-- turbine j
-						 \/
-						 */
-						downstream(i, j, l) = 0;
-
-						if (i != j) {
-							double al = atan(alpha); //half angle of the wake spread
-							double a = 1 - sqrt(1 - getCt(windSpeeds(w, l)));
-
-							//TODO: Use Ct-dependent wake radius
-							// If considering Ct-dependent wake radius immediately behind turbine, use the first method; otherwise the second one is closer with OpenWind results
-							double r;
+		// Calculate the total wake effects on each turbine i.
+		// Without a Ct-dependent wake radius the wake cone of j is the same for every
+		// speed bin, so the geometry is done once per direction and only the deficits
+		// are computed per bin; otherwise the geometry has to be redone for each bin.
 #ifdef CT_DEPENDENT
-								r = r0j * (1 - 0.5 * a) / (1 - a); // radius of wake immediately behind turbine
-#else
-								r = r0j;
-#endif
-
-							vec pt1(2); // coordinates of the "left" end of initial wake cone
-							vec pt2(2); // coordinates of the "right" end of initial wake cone
-							pt1(0) = someTurbineCoordinates(j)
-									+ r * cos(theta + PI / 2);
-							pt2(0) = someTurbineCoordinates(j)
-									+ r * cos(theta - PI / 2);
-							pt1(1) = someTurbineCoordinates(j + numT)
-									+ r * sin(theta + PI / 2);
-							pt2(1) = someTurbineCoordinates(j + numT)
-									+ r * sin(theta - PI / 2);
-
-							vec pt3(2); // coordinates of the "left" end of turbine i
-							vec pt4(2); // coordinates of the "right" end of turbine i
-							pt3(0) = someTurbineCoordinates(i)
-									+ r0i * cos(theta + PI / 2);
-							pt4(0) = someTurbineCoordinates(i)
-									+ r0i * cos(theta - PI / 2);
-							pt3(1) = someTurbineCoordinates(i + numT)
-									+ r0i * sin(theta + PI / 2);
-							pt4(1) = someTurbineCoordinates(i + numT)
-									+ r0i * sin(theta - PI / 2);
-
-							int num_dtPoints = 10;
-							vec dtPointsInWake = zeros(num_dtPoints);
-							for (int s = 0; s < num_dtPoints; s++) {
-								vec dtPoint(2); // one point on the rotor of downstream turbine i
-								dtPoint(0) = (pt3(0) - pt4(0)) * s
-										/ num_dtPoints + pt4(0);
-								dtPoint(1) = (pt3(1) - pt4(1)) * s
-										/ num_dtPoints + pt4(1);
-								vec r1(2); //vector pointing from pt1 to the point on turbine i
-								vec r2(2);
-								r1(0) = dtPoint(0) - pt1(0);
-								r1(1) = dtPoint(1) - pt1(1);
-								r2(0) = dtPoint(0) - pt2(0);
-								r2(1) = dtPoint(1) - pt2(1);
-
-								vec r1_hat = r1 / norm(r1, 2); // normalized r1
-								vec r2_hat = r2 / norm(r2, 2);
-
-								double halfangle = (al + PI / 2) / 2;
-
-								vec pt1_c(2); // centre line at pt1 between wake left boundary and turbine
-								vec pt2_c(2);
-								pt1_c(0) = cos(theta - PI / 2 + halfangle);
-								pt1_c(1) = sin(theta - PI / 2 + halfangle);
-								pt2_c(0) = cos(theta + PI / 2 - halfangle);
-								pt2_c(1) = sin(theta + PI / 2 - halfangle);
-
-								if (pt1_c(0) * r1_hat(0) + pt1_c(1) * r1_hat(1)
-										>= cos(halfangle)
-										&& pt2_c(0) * r2_hat(0)
-												+ pt2_c(1) * r2_hat(1)
-												>= cos(halfangle))
-												//if (dot(pt1_c, r1_hat) >= cos(halfangle) && dot(pt2_c, r2_hat) >= cos(halfangle))
-														{
-									downstream(i, j, l) = 1;
-									dtPointsInWake(s) = 1;
-								}
-							}
-							overlap(i, j, l) = (double) sum(dtPointsInWake)
-									/ num_dtPoints;
-						}
-					}
-				}
-			}
+		for (unsigned l = 0; l < numBins; l++) {
+			computeWakeGeometry(someTurbineCoordinates, theta, binInduction(l, w), overlap, distance);
+			accumulateWakeDeficits(overlap, distance, w, l, l + 1, defSumSqr);
 		}
-
-		mat effSpeed(numT, windSpeeds.n_cols); //stores final effective wind speed at i
-		mat defSumSqr = zeros(numT, windSpeeds.n_cols); // sum of the sqr of deficits (0~1) from multiple wakes
-
-		// Calculate the total power produced by turbine i
-		// First, calculate the total wake effects on turbine i
-		// Second, calculate the resulting wind speed and power output
-		for (unsigned i = 0; i < numT; i++) {
-
-			for (unsigned j = 0; j < numT; j++) {
-				// dromero
-				// use a turbine-specific rotor diameter
-				double r0j = this->DRot(j) / 2;
-				// calculates wake expansion angle based on this turbine's height
-				double alpha = 0.5 / log(this->Z(j) / this->Z0(j));
-
-				for (unsigned l = 0; l < windSpeeds.n_cols; l++) {
-					if (j != i && downstream(i, j, l) == 1) // if downstream and different turbines
-							{
-						double dd = (someTurbineCoordinates(i)
-								- someTurbineCoordinates(j)) * cos(theta)
-								+ (someTurbineCoordinates(i + numT)
-										- someTurbineCoordinates(j + numT))
-										* sin(theta);
-						double a = 1 - sqrt(1 - getCt(windSpeeds(w, l)));
-
-						// If considering Ct-dependent wake radius immediately behind turbine, use the first method; otherwise the second one is closer with OpenWind results
-						double r;
-#ifdef CT_DEPENDENT
-							r = r0j * (1 - 0.5 * a) / (1 - a); // radius of wake immediately behind turbine
 #else
-							r = r0j;
+		computeWakeGeometry(someTurbineCoordinates, theta, 0.0, overlap, distance);
+		accumulateWakeDeficitsAllBins(overlap, distance, binInduction.memptr() + w * binInduction.n_rows, numBins, shrink.memptr(), sourceOverlap.memptr(), defSumSqr);
 #endif
 
-						double deficit = (1 - sqrt(1 - getCt(windSpeeds(w, l))))
-								* pow(r / (r + alpha * dd), 2.0)
-								* overlap(i, j, l); // the Modified Park way
-						defSumSqr(i, l) += pow(deficit, 2);
-					}
-				}
-			}
-		}
+		for (unsigned l = 0; l < numBins; l++)
+			for (unsigned i = 0; i < numT; i++)
+				effSpeed(i, l) = windSpeeds(w, l) * (1 - sqrt(defSumSqr(l, i)));
 
+		// the power at all the effective speeds of the direction at once
+		powerCurve.interpolate(effSpeed.memptr(), effSpeedPower.memptr(), numT * numBins);
 
 	// Should be using structs instead here, very annoying to use hard names for packaged variables. 
-		for (unsigned l = 0; l < windSpeeds.n_cols; l++) {
+		for (unsigned l = 0; l < numBins; l++) {
 			for (unsigned i = 0; i < numT; i++) {
-				effSpeed(i, l) = windSpeeds(w, l) * (1 - sqrt(defSumSqr(i, l)));
-				totalPower += getPower(effSpeed(i, l)) * windProb(w, l);
-				upperbound += getPower(windSpeeds(w, l)) * windProb(w, l);
-				effPower(i, w) += getPower(effSpeed(i, l)) * windProb(w, l);
+				double power = effSpeedPower(i, l) * windProb(w, l);
+				totalPower += power;
+				upperbound += binFreePower(l, w);
+				effPower(i, w) += power;
 				tEffSpeed(i, w) += effSpeed(i, l) * windProb(w, l);
 			}
 
@@ -347,28 +252,188 @@ double WindFarmLayout::calculateFarmPower (arma::vec someTurbineCoordinates){
 
 	} // END of for over wind directions
 
+	// the bins dropped from the wind rose still count in the wake-free power
+	upperbound += numT * droppedFreePower;
+
 	// dromero
 	// Calculates the effective wind speed at each turbine for each wind direction w, as an expected value using windProb
 	// Save Effective wind speeds for each turbine, so that we can use them for noise calculations.
 	// Note that there is a probability for each wind speed and direction. To calculate this, we are using the marginal probability for wind direction, i.e., we sum up the probabilityes across the wind speeds.
-	this->turbineEffectiveWindSpeeds = sum(tEffSpeed, 1);
-	this->turbinePowers = sum(effPower, 1) * 8766 / 1000000;
-	this->AEP = sum(this->turbinePowers);
+	result->turbineEffectiveWindSpeeds = sum(tEffSpeed, 1);
+	result->turbinePowers = sum(effPower, 1) * 8766 / 1000000;
+	result->AEP = sum(result->turbinePowers);
 
-	// Stores the calculated efficiency in this instance of the object
-	this->farmEfficiency = totalPower / upperbound;
+	// Stores the calculated efficiency in the result
+	result->farmEfficiency = totalPower / upperbound;
 
-	//cout << "Total power: " << totalPower << " (" << farmEfficiency * 100 << "%)" << endl;
-	//cout << "Effective Wind Speeds at each Turbine" << endl << turbineEffectiveWindSpeeds;
+	//cout << "Total power: " << totalPower << " (" << result->farmEfficiency * 100 << "%)" << endl;
+	//cout << "Effective Wind Speeds at each Turbine" << endl << result->turbineEffectiveWindSpeeds;
 
-	if (farmEfficiency == 1) {
-	//	cout << "Total power: " << totalPower << " (" << farmEfficiency * 100 << "%)" << endl;
+	if (result->farmEfficiency == 1) {
+	//	cout << "Total power: " << totalPower << " (" << result->farmEfficiency * 100 << "%)" << endl;
 	}	
-	return ((this->farmEfficiency)*100);
+	return ((result->farmEfficiency)*100);
 	
 
 }
 
+// radius of the wake immediately behind a turbine with rotor radius r0 and axial induction a
+double WindFarmLayout::wakeRadius (double r0, double a) const{
+	//TODO: Use Ct-dependent wake radius
+	// If considering Ct-dependent wake radius immediately behind turbine, use the first method; otherwise the second one is closer with OpenWind results
+#ifdef CT_DEPENDENT
+	return r0 * (1 - 0.5 * a) / (1 - a);
+#else
+	return r0;
+#endif
+}
+
+// Geometry stage: for the wind direction theta, fills overlap(i, j) with the fraction of the
+// rotor of turbine i lying in the wake cone of turbine j (0 if i is not downstream of j) and
+// distance(i, j) with the stream-wise distance from j to i. The axial induction a is only used
+// for the Ct-dependent wake radius.
+// The offset of each pair is rotated into the frame of the wind (u down the wind, v across
+// it), where the wake cone of j is |v| <= r + alpha * u for u >= 0; see rotorOverlap for
+// how much of the rotor of i is in it.
+void WindFarmLayout::computeWakeGeometry (const arma::vec &someTurbineCoordinates, double theta, double a, arma::mat &overlap, arma::mat &distance) const{
+
+	unsigned numT = someTurbineCoordinates.n_elem / 2;
+	double cosTheta = cos(theta);
+	double sinTheta = sin(theta);
+
+	for (unsigned i = 0; i < numT; i++) {
+		// dromero
+		// use a turbine-specific rotor diameter
+		double r0i = this->DRot(i) / 2;
+		double xi = someTurbineCoordinates(i);
+		double yi = someTurbineCoordinates(i + numT);
+
+		for (unsigned j = 0; j < numT; j++) {
+			double dx = xi - someTurbineCoordinates(j);
+			double dy = yi - someTurbineCoordinates(j + numT);
+			double du = dx * cosTheta + dy * sinTheta; // down the wind
+			double dv = dy * cosTheta - dx * sinTheta; // across the wind
+
+			overlap(i, j) = 0;
+			distance(i, j) = du;
+
+			if (i == j || du <= 0) // turbines side by side (or on the same spot) do not shade each other
+				continue;
+
+			// half width of the wake of j where i stands
+			double halfWidth = wakeRadius(this->DRot(j) / 2, a) + this->wakeSpread(j) * du;
+
+			overlap(i, j) = rotorOverlap(dv, r0i, halfWidth);
+		}
+	}
+}
+
+// Fraction of a rotor of radius r0 lying in a wake of the given half width, the centre of
+// the rotor being dv across the wind from the centre line of the wake. The sampled way
+// (the original one) counts which of 10 points along the rotor are in the wake, so it moves
+// in steps of 0.1; the segment way is the exact fraction of the rotor seen from above; the
+// area way takes both the rotor and the wake section as discs at the same height and gives
+// the fraction of the rotor disc covered by the wake.
+double WindFarmLayout::rotorOverlap (double dv, double r0, double halfWidth) const{
+
+	if (overlapMode == WAKE_OVERLAP_SEGMENT) {
+		double left = (dv - r0 > -halfWidth)? dv - r0 : -halfWidth;
+		double right = (dv + r0 < halfWidth)? dv + r0 : halfWidth;
+
+		return (right > left)? (right - left) / (2 * r0) : 0.0;
+	}
+
+	if (overlapMode == WAKE_OVERLAP_AREA) {
+		double d = fabs(dv);
+
+		if (d >= r0 + halfWidth)
+			return 0.0;
+		if (d <= halfWidth - r0)
+			return 1.0;
+		if (d <= r0 - halfWidth)
+			return (halfWidth * halfWidth) / (r0 * r0);
+
+		// the lens where the discs cross
+		double c0 = (d * d + r0 * r0 - halfWidth * halfWidth) / (2 * d * r0);
+		double c1 = (d * d + halfWidth * halfWidth - r0 * r0) / (2 * d * halfWidth);
+		c0 = (c0 > 1)? 1 : ((c0 < -1)? -1 : c0);
+		c1 = (c1 > 1)? 1 : ((c1 < -1)? -1 : c1);
+
+		double lens = r0 * r0 * acos(c0) + halfWidth * halfWidth * acos(c1)
+				- 0.5 * sqrt((-d + r0 + halfWidth) * (d + r0 - halfWidth) * (d - r0 + halfWidth) * (d + r0 + halfWidth));
+
+		return lens / (PI * r0 * r0);
+	}
+
+	const int num_dtPoints = 10;
+	int inWake = 0;
+
+	for (int s = 0; s < num_dtPoints; s++)
+		if (fabs(dv + r0 * (2.0 * s / num_dtPoints - 1)) <= halfWidth)
+			inWake++;
+
+	return (double) inWake / num_dtPoints;
+}
+
+// Deficit stage: adds the squared Modified Park deficits caused on each turbine i by every
+// turbine j it overlaps with to defSumSqr(l, i), for the speed bins firstBin..lastBin-1 of
+// the wind direction w.
+void WindFarmLayout::accumulateWakeDeficits (const arma::mat &overlap, const arma::mat &distance, unsigned w, unsigned firstBin, unsigned lastBin, arma::mat &defSumSqr) const{
+
+	unsigned numT = overlap.n_rows;
+
+	for (unsigned i = 0; i < numT; i++) {
+
+		for (unsigned j = 0; j < numT; j++) {
+			if (j == i || overlap(i, j) == 0) // only downstream and different turbines
+				continue;
+
+			// dromero
+			// use a turbine-specific rotor diameter
+			double r0j = this->DRot(j) / 2;
+			double alpha = this->wakeSpread(j); // wake expansion, based on this turbine's height
+			double dd = distance(i, j);
+
+			for (unsigned l = firstBin; l < lastBin; l++) {
+				double a = binInduction(l, w);
+				double r = wakeRadius(r0j, a);
+
+				double deficit = a
+						* pow(r / (r + alpha * dd), 2.0)
+						* overlap(i, j); // the Modified Park way
+				defSumSqr(l, i) += pow(deficit, 2);
+			}
+		}
+	}
+}
+
+// Deficit stage for a wake radius that does not depend on Ct: the wake of j shrinks with the
+// distance in the same way for all the bins, so for each turbine i the sources it overlaps
+// with are listed first and then the deficits of all the bins are added by the vectorized
+// kernel (deficitKernel.cc). The first numBins bins of turbine i are in column i of defSumSqr.
+// shrink and sourceOverlap are work buffers of (at least) one element per turbine, given by the
+// caller so that nothing is allocated per direction.
+void WindFarmLayout::accumulateWakeDeficitsAllBins (const arma::mat &overlap, const arma::mat &distance, const double *induction, unsigned numBins, double *shrink, double *sourceOverlap, arma::mat &defSumSqr) const{
+
+	unsigned numT = overlap.n_rows;
+
+	for (unsigned i = 0; i < numT; i++) {
+		int numSources = 0;
+
+		for (unsigned j = 0; j < numT; j++) {
+			if (j == i || overlap(i, j) == 0) // only downstream and different turbines
+				continue;
+
+			double r = wakeRadius(this->DRot(j) / 2, 0.0);
+			shrink[numSources] = pow(r / (r + this->wakeSpread(j) * distance(i, j)), 2.0); // (r / (r + alpha * dd))^2 of the source
+			sourceOverlap[numSources] = overlap(i, j);
+			numSources++;
+		}
+
+		accumulateDeficits(induction, numBins, shrink, sourceOverlap, numSources, defSumSqr.memptr() + i * defSumSqr.n_rows);
+	}
+}
+
 void WindFarmLayout::validate(){
 
 	unsigned numT = this->numT;
@@ -390,30 +455,121 @@ void WindFarmLayout::validate(){
 		t.fill(this->Z0(0));
 		this->Z0 = t;
 	}
+
+	// calculates wake expansion of each turbine based on its height
+	this->wakeSpread = arma::zeros<vec>(numT);
+	for (unsigned j = 0; j < numT; j++)
+		this->wakeSpread(j) = 0.5 / log(this->Z(j) / this->Z0(j));
+
+	// the turbine curves and what does not depend on the layout in each bin
+	this->powerCurve.build(this->powerTable, 0.0);
+	this->ctCurve.build(this->Ct, 1.0);
+
+	this->binsPerDirection.assign(windDirections.n_elem, windSpeeds.n_cols);
+	this->droppedFreePower = 0.0;
+	this->windRoseErrorBound = 0.0;
+
+	prepareBins();
 }
 
+// what does not depend on the layout in each (speed bin, direction) of the wind rose
+void WindFarmLayout::prepareBins(){
 
-double WindFarmLayout::getPower(double v){
-	
-	for (unsigned i = 0; i < powerTable.n_rows - 1; i++)
-		if (powerTable(i, 0) <= v && v <= powerTable(i + 1, 0)) {
-			return powerTable(i, 1)
-					+ (powerTable(i + 1, 1) - powerTable(i, 1))
-							* (v - powerTable(i, 0))
-							/ (powerTable(i + 1, 0) - powerTable(i, 0)); // linear interpolation
+	this->binInduction = arma::zeros<mat>(windSpeeds.n_cols, windDirections.n_elem);
+	this->binFreePower = arma::zeros<mat>(windSpeeds.n_cols, windDirections.n_elem);
+	for (unsigned w = 0; w < windDirections.n_elem; w++)
+		for (unsigned l = 0; l < windSpeeds.n_cols; l++) {
+			this->binInduction(l, w) = 1 - sqrt(1 - getCt(windSpeeds(w, l)));
+			this->binFreePower(l, w) = getPower(windSpeeds(w, l)) * windProb(w, l);
 		}
-	
-	return 0;
 }
 
-double WindFarmLayout::getCt(double v) {
-	for (unsigned i = 0; i < Ct.n_rows - 1; i++)
-		if (Ct(i, 0) <= v && v <= Ct(i + 1, 0))
-			return Ct(i, 1)
-					+ (Ct(i + 1, 1) - Ct(i, 1)) * (v - Ct(i, 0))
-							/ (Ct(i + 1, 0) - Ct(i, 0)); // linear interpolation
+// Drops the least probable bins of the wind rose as long as the efficiency of any layout can
+// not change by more than maxError (the AEP by more than maxError times the wake-free AEP):
+// no turbine makes more than the top of the power curve, so leaving out bins of total
+// probability q changes the power by at most q * maxPower per turbine, while the wake-free
+// power used for the efficiency keeps the dropped bins (droppedFreePower). The bins left in
+// a direction are moved to the front of its row and the rows are cut to the longest one.
+// Returns the bound achieved (the bounds of repeated calls add up in windRoseErrorBound).
+double WindFarmLayout::compressWindRose(double maxError){
+
+	unsigned numDirections = windDirections.n_elem;
+	unsigned numSpeeds = windSpeeds.n_cols;
+
+	double maxPower = 0.0;
+	for (unsigned i = 0; i < powerTable.n_rows; i++)
+		if (powerTable(i, 1) > maxPower)
+			maxPower = powerTable(i, 1);
+
+	double freePower = droppedFreePower; // wake-free power of a turbine over the whole wind rose
+	for (unsigned w = 0; w < numDirections; w++)
+		for (unsigned l = 0; l < binsPerDirection[w]; l++)
+			freePower += binFreePower(l, w);
+
+	if (maxError <= 0 || maxPower <= 0 || freePower <= 0)
+		return 0.0;
+
+	// the bins from the least probable one
+	std::vector< std::pair<double, unsigned> > bins;
+	for (unsigned w = 0; w < numDirections; w++)
+		for (unsigned l = 0; l < binsPerDirection[w]; l++)
+			bins.push_back(std::make_pair(windProb(w, l), w * numSpeeds + l));
+	std::sort(bins.begin(), bins.end());
+
+	std::vector<bool> dropped(numDirections * numSpeeds, false);
+	double droppedProb = 0.0;
+	for (unsigned k = 0; k < bins.size(); k++) {
+		if (maxPower * (droppedProb + bins[k].first) / freePower > maxError)
+			break;
+		droppedProb += bins[k].first;
+		dropped[bins[k].second] = true;
+	}
+
+	// the compacted wind rose
+	unsigned newSpeeds = 0;
+	std::vector<unsigned> kept(numDirections, 0);
+	for (unsigned w = 0; w < numDirections; w++) {
+		for (unsigned l = 0; l < binsPerDirection[w]; l++)
+			if (!dropped[w * numSpeeds + l])
+				kept[w]++;
+			else
+				droppedFreePower += binFreePower(l, w);
+		if (kept[w] > newSpeeds)
+			newSpeeds = kept[w];
+	}
+	if (newSpeeds == 0)
+		newSpeeds = 1;
+
+	arma::mat speeds = arma::zeros<mat>(numDirections, newSpeeds);
+	arma::mat prob = arma::zeros<mat>(numDirections, newSpeeds);
+	for (unsigned w = 0; w < numDirections; w++) {
+		unsigned k = 0;
+		for (unsigned l = 0; l < binsPerDirection[w]; l++)
+			if (!dropped[w * numSpeeds + l]) {
+				speeds(w, k) = windSpeeds(w, l);
+				prob(w, k) = windProb(w, l);
+				k++;
+			}
+		binsPerDirection[w] = kept[w];
+	}
+
+	this->windSpeeds = speeds;
+	this->windProb = prob;
+	prepareBins();
+
+	double bound = maxPower * droppedProb / freePower;
+	this->windRoseErrorBound += bound;
+
+	return bound;
+}
+
+
+double WindFarmLayout::getPower(double v) const{
+	return powerCurve.interpolate(v); // linear interpolation in powerTable, 0 outside
+}
 
-	return 1;
+double WindFarmLayout::getCt(double v) const{
+	return ctCurve.interpolate(v); // linear interpolation in Ct, 1 outside
 }
 
 
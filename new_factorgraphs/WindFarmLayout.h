@@ -9,12 +9,26 @@
 #include <stdlib.h>
 #include <math.h>
 #include "armadillo"
+#include "CurveLookup.h"
 
 #define PI 3.1415926535897932 // less expensive than acos(-1)
 
+#define WAKE_OVERLAP_SAMPLED 0 // fraction of 10 points along the rotor that are in the wake
+#define WAKE_OVERLAP_SEGMENT 1 // exact fraction of the rotor (seen from above) in the wake
+#define WAKE_OVERLAP_AREA    2 // exact fraction of the rotor disc inside the wake disc
+
 using namespace std;
 using namespace arma;
 
+// Results of evaluating one layout; owned by the caller so that several layouts can be
+// evaluated at the same time
+struct FarmPowerResult {
+	arma::vec turbinePowers;
+	arma::vec turbineEffectiveWindSpeeds;
+	double farmEfficiency;
+	double AEP;
+};
+
 class WindFarmLayout {
 
 	public:
@@ -37,6 +51,14 @@ class WindFarmLayout {
 		arma::mat windSpeeds; //wind speeds
 		arma::mat windProb; //wind probabilities
 		arma::mat Z0; //terrain data
+		arma::vec wakeSpread; //wake expansion coefficient alpha of each turbine
+		CurveLookup powerCurve; //powerTable with constant time lookups
+		CurveLookup ctCurve; //Ct with constant time lookups
+		arma::mat binInduction; //axial induction of each (speed bin, direction)
+		arma::mat binFreePower; //wake-free power of a turbine times the probability of each (speed bin, direction)
+		std::vector<unsigned> binsPerDirection; //speed bins used in each direction (the first ones of its row)
+		double droppedFreePower; //wake-free power of a turbine in the bins dropped from the wind rose
+		double windRoseErrorBound; //bound on the change of the efficiency caused by dropping them
 
 		arma::vec turbinePowers;
 		arma::vec turbineEffectiveWindSpeeds;
@@ -45,6 +67,7 @@ class WindFarmLayout {
 		double Proximity;
 		double AEP;
 		double SPL;
+		int overlapMode; //how the fraction of a rotor in a wake is computed (WAKE_OVERLAP_...)
 		
 
 	WindFarmLayout(const char *wind_farm_layout_file_path, const char *turbine_coordinates_file_path, const char *wind_resource_file_path, string fcoordinates,
@@ -55,6 +78,7 @@ class WindFarmLayout {
 	void setWindFarmLayoutFile (const char *wind_farm_layout_file_path);
 	void setWindFarmTurbineCoordinatesFiles (const char *turbine_coordinates_file_path); 
 	void setWindResourceFile (const char *wind_resource_file_path);
+	void setOverlapMode (int overlapMode);
 
 	//READ Functions
 	void readWindFarmLayoutFile ();
@@ -68,12 +92,22 @@ class WindFarmLayout {
 	arma::vec getTurbineCoordinates ();
 	double getTotalFarmPower ();
 	arma::mat getConstraintsCoordinates();	
-	double getPower(double v);
-	double getCt(double v);
+	double getPower(double v) const;
+	double getCt(double v) const;
 
-	//Calculate Function
+	//Calculate Functions
 	double calculateFarmPower (arma::vec someTurbineCoordinates);	
+	double evaluateLayout (const arma::vec &someTurbineCoordinates, FarmPowerResult *result) const;
 	void validate();
+	void prepareBins();
+	double compressWindRose(double maxError);
+
+	//Wake model stages (used by evaluateLayout)
+	double wakeRadius (double r0, double a) const;
+	double rotorOverlap (double dv, double r0, double halfWidth) const;
+	void computeWakeGeometry (const arma::vec &someTurbineCoordinates, double theta, double a, arma::mat &overlap, arma::mat &distance) const;
+	void accumulateWakeDeficits (const arma::mat &overlap, const arma::mat &distance, unsigned w, unsigned firstBin, unsigned lastBin, arma::mat &defSumSqr) const;
+	void accumulateWakeDeficitsAllBins (const arma::mat &overlap, const arma::mat &distance, const double *induction, unsigned numBins, double *shrink, double *sourceOverlap, arma::mat &defSumSqr) const;
 
 };
 
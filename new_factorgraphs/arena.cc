@@ -0,0 +1,243 @@
+// ################################################################################
+//
+// name:          arena.cc
+//
+// purpose:       a bump allocator for the memory that lives and dies together (the
+//                decision graphs of one generation); the blocks are carved out of
+//                large chunks and are all given back by one reset
+//
+// ################################################################################
+
+#include <stdio.h>
+#include <string.h>
+
+#include "arena.h"
+#include "memalloc.h"
+
+// -----------------------------------------------------------
+// the blocks are aligned to this many bytes (and so is the
+// header of a chunk)
+// -----------------------------------------------------------
+
+#define ARENA_ALIGNMENT 16
+
+#define ARENA_HEADER ((long) ((sizeof(ArenaChunk)+ARENA_ALIGNMENT-1)&~(ARENA_ALIGNMENT-1)))
+
+static ArenaChunk *newChunk(long size);
+
+// ================================================================================
+//
+// name:          initializeArena
+//
+// function:      initializes an empty arena
+//
+// parameters:    arena........the arena
+//                chunkSize....the size of the first chunk (the later ones double)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int initializeArena(Arena *arena, long chunkSize)
+{
+  arena->first     = NULL;
+  arena->current   = NULL;
+  arena->chunkSize = chunkSize;
+  arena->used      = 0;
+  arena->peak      = 0;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          doneArena
+//
+// function:      frees all the chunks of an arena
+//
+// parameters:    arena........the arena
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int doneArena(Arena *arena)
+{
+  ArenaChunk *chunk,*next;
+
+  for (chunk=arena->first; chunk; chunk=next)
+    {
+      next = chunk->next;
+      Free(chunk);
+    }
+
+  arena->first   = NULL;
+  arena->current = NULL;
+  arena->used    = 0;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          arenaAlloc
+//
+// function:      allocates a zeroed block of memory in an arena (a new chunk is
+//                added when the current one is full)
+//
+// parameters:    arena........the arena
+//                size.........the size of the block in bytes
+//
+// returns:       (void*) the block
+//
+// ================================================================================
+
+void *arenaAlloc(Arena *arena, long size)
+{
+  ArenaChunk *chunk;
+  void *block;
+
+  size = (size+ARENA_ALIGNMENT-1)&~((long) ARENA_ALIGNMENT-1);
+
+  // a new chunk if the current one is full (the chunks are used one after
+  // another, so the current one is the last)
+
+  chunk = arena->current;
+
+  if ((chunk==NULL)||(chunk->used+size>chunk->size))
+    {
+      while (arena->chunkSize<size)
+	arena->chunkSize *= 2;
+
+      chunk = newChunk(arena->chunkSize);
+      arena->chunkSize *= 2;
+
+      if (arena->current)
+	arena->current->next = chunk;
+      else
+	arena->first = chunk;
+    }
+
+  arena->current = chunk;
+
+  // hand out the block
+
+  block        = ((char*) chunk)+ARENA_HEADER+chunk->used;
+  chunk->used += size;
+
+  arena->used += size;
+  if (arena->used>arena->peak)
+    arena->peak = arena->used;
+
+  memset(block,0,size);
+
+  // get back
+
+  return block;
+}
+
+// ================================================================================
+//
+// name:          resetArena
+//
+// function:      gives back all the blocks of an arena at once; when the blocks
+//                took more than one chunk, the chunks are replaced by a single one
+//                holding them all, so that the next round needs no allocations
+//
+// parameters:    arena........the arena
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int resetArena(Arena *arena)
+{
+  long total;
+  ArenaChunk *chunk;
+
+  // one chunk only?
+
+  if ((arena->first!=NULL)&&(arena->first->next!=NULL))
+    {
+      total = 0;
+      for (chunk=arena->first; chunk; chunk=chunk->next)
+	total += chunk->size;
+
+      doneArena(arena);
+
+      arena->first = newChunk(total);
+    }
+
+  if (arena->first)
+    arena->first->used = 0;
+
+  arena->current = arena->first;
+  arena->used    = 0;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          getArenaUsed
+//
+// function:      returns the number of bytes handed out since the last reset
+//
+// parameters:    arena........the arena
+//
+// returns:       (long) the number of bytes
+//
+// ================================================================================
+
+long getArenaUsed(Arena *arena)
+{
+  return arena->used;
+}
+
+// ================================================================================
+//
+// name:          getArenaPeak
+//
+// function:      returns the maximal number of bytes ever handed out at once
+//
+// parameters:    arena........the arena
+//
+// returns:       (long) the number of bytes
+//
+// ================================================================================
+
+long getArenaPeak(Arena *arena)
+{
+  return arena->peak;
+}
+
+// ================================================================================
+//
+// name:          newChunk
+//
+// function:      allocates a new empty chunk
+//
+// parameters:    size.........the size of the chunk (without the header)
+//
+// returns:       (ArenaChunk*) the chunk
+//
+// ================================================================================
+
+static ArenaChunk *newChunk(long size)
+{
+  ArenaChunk *chunk;
+
+  chunk = (ArenaChunk*) Malloc(ARENA_HEADER+size);
+
+  chunk->next = NULL;
+  chunk->size = size;
+  chunk->used = 0;
+
+  return chunk;
+}
@@ -0,0 +1,35 @@
+#ifndef _arena_h_
+#define _arena_h_
+
+// -------------------------------------------------------
+// a chunk of memory the arena hands out blocks from
+// -------------------------------------------------------
+
+struct ArenaChunk {
+  ArenaChunk *next;
+  long       size;      // bytes in the chunk (after the header)
+  long       used;      // bytes handed out
+};
+
+// -------------------------------------------------------
+// an arena: blocks are allocated one after another and all
+// freed at once by resetArena
+// -------------------------------------------------------
+
+struct Arena {
+  ArenaChunk *first;
+  ArenaChunk *current;
+  long       chunkSize;  // the size of the next chunk
+  long       used;       // bytes handed out since the last reset
+  long       peak;       // maximal used ever
+};
+
+int   initializeArena(Arena *arena, long chunkSize);
+int   doneArena(Arena *arena);
+void *arenaAlloc(Arena *arena, long size);
+int   resetArena(Arena *arena);
+
+long  getArenaUsed(Arena *arena);
+long  getArenaPeak(Arena *arena);
+
+#endif
@@ -23,8 +23,44 @@
 #include "random.h"
 #include "operator.h"
 #include "mymath.h"
+#include "threadPool.h"
+#include "operatorQueue.h"
+#include "sampler.h"
 
 #define FIXED_THRESHOLD 0.000
+
+// -------------------------------------------------------------------
+// the frequencies of up to this many splits of a leaf are on the stack
+// -------------------------------------------------------------------
+
+#define MAX_STACK_CANDIDATES 256
+
+// ---------------------------------------------------------------
+// how many chunks per thread the recomputation of the split gains is
+// cut into (the leaves with more instances even out)
+// ---------------------------------------------------------------
+
+#define SPLIT_GAINS_CHUNKS_PER_THREAD 4
+
+// -------------------------------------------------------------
+// the leaves whose split gains are recomputed by parallel tasks
+// -------------------------------------------------------------
+
+typedef struct {
+  FrequencyDecisionGraph **t;
+  LabeledTreeNode      **x;
+  long                 N;
+} SplitGainsTask;
+
+static int recomputeSplitGains(long first, long last, int thread, void *data);
+
+// ---------------------------------------------------------------
+// the rounds of model building and the operators applied in them
+// (over all the networks built so far)
+// ---------------------------------------------------------------
+
+static long numRounds=0;
+static long numAppliedOperators=0;
 // ================================================================================
 //
 // name:          constructTheFactorGraphNetwork
@@ -80,12 +116,24 @@ int constructTheNetwork(AcyclicOrientedGraph *G,
   int    maxIncoming;
   MergeOperator **merge;
   int           *numMerges;
+  int           *mergeSize;
 
   char **canAdd;
 
   long     operatorsLeft;
   Operator bestOperator;
   Operator *bestNodeOperator;
+  Operator *batch;
+  Operator swap;
+  int      numBatch;
+  int      numApplied;
+  int      k,where;
+
+  LabeledTreeNode **root;
+  int             *node;
+
+  SplitQueue *splitQueue;
+  NodeQueue  nodeQueue;
 
   // no operators applied
 
@@ -113,11 +161,13 @@ int constructTheNetwork(AcyclicOrientedGraph *G,
   // we'll allocate some memory for the info on merge operators
 
   numMerges = (int*) Calloc(n,sizeof(int));
+  mergeSize = (int*) Calloc(n,sizeof(int));
   merge = (MergeOperator**) Calloc(n,sizeof(MergeOperator*));
   for (i=0; i<n; i++)
     {
       merge[i]=NULL;
       numMerges[i]=0;
+      mergeSize[i]=0;
     };
 
   // remove all edges (just in case...)
@@ -138,66 +188,119 @@ int constructTheNetwork(AcyclicOrientedGraph *G,
 
   // allocate and recompute the gains (not to worry about freeing them, it is done automatically)
 
+  root = (LabeledTreeNode**) Calloc(n,sizeof(LabeledTreeNode*));
+  node = (int*) Calloc(n,sizeof(int));
+
   for (i=0; i<n; i++)
     {
-      T[i]->getLeaves()->x->dArrayTmp=(double*) Calloc(n,sizeof(double));
-      T[i]->getLeaves()->x->rightValue0Array = (double*) Calloc(G->size(),sizeof(double));
-      T[i]->getLeaves()->x->rightValue1Array = (double*) Calloc(G->size(),sizeof(double));
-      T[i]->getLeaves()->x->leftValue0Array = (double*) Calloc(G->size(),sizeof(double));
-      T[i]->getLeaves()->x->leftValue1Array = (double*) Calloc(G->size(),sizeof(double));
-      recomputeDecisionGraphSplitGains(T[i],T[i]->getLeaves()->x,G,maxIncoming,i,n,N);
-      updateBestNodeOperator(&(bestNodeOperator[i]),T[i],merge[i],numMerges[i],i,n);
-      updateBestOperator(&bestOperator,&(bestNodeOperator[i]));
+      root[i] = T[i]->getLeaves()->x;
+      node[i] = i;
     };
 
+  // the trees are independent, so their gains can be computed at the same time
+
+  recomputeSplitGainsInParallel(n,T,root,node,G,maxIncoming,n,N);
+
+  // queue the leaves of each graph and the variables by the best gains
+
+  splitQueue = (SplitQueue*) Calloc(n,sizeof(SplitQueue));
+
+  for (i=0; i<n; i++)
+    {
+      initializeSplitQueue(&(splitQueue[i]));
+      updateSplitQueue(&(splitQueue[i]),root[i]);
+      updateBestNodeOperator(&(bestNodeOperator[i]),T[i],&(splitQueue[i]),merge[i],numMerges[i],i);
+    };
+
+  initializeNodeQueue(&nodeQueue,bestNodeOperator,n);
+  updateBestOperator(&bestOperator,&(bestNodeOperator[getBestNode(&nodeQueue)]));
+
+  Free(root);
+  Free(node);
+
   // all operators are left now, we can split in each node once on any variable
 
   operatorsLeft = n*n;
 
+  // the operators of a round (applicable ones are moved to its front)
+
+  batch = (Operator*) Calloc(n,sizeof(Operator));
+
   // while we gained and can do some more do splits
 
   while ((bestOperator.gain>0)&&(operatorsLeft>0))
     {
+      // take the best operator, or the best operator of each variable (they
+      // are on different variables, so they don't touch the same graphs)
 
-      if (operatorApplicable(&bestOperator,G))
+      if (params->modelBuildMode==MODEL_BUILD_BATCHED)
+	numBatch = getOperatorBatch(bestNodeOperator,n,batch);
+      else
 	{
-	  // apply the operator
+	  memcpy(&(batch[0]),&bestOperator,sizeof(Operator));
+	  numBatch = 1;
+	}
+
+      // apply them one after another, so that each split is checked against
+      // the edges added by those before it
+
+      numApplied = 0;
+      for (k=0; k<numBatch; k++)
+	if (operatorApplicable(&(batch[k]),G))
+	  {
+	    applyOperator(&(batch[k]),G);
+
+	    if (k!=numApplied)
+	      {
+		swap              = batch[k];
+		batch[k]          = batch[numApplied];
+		batch[numApplied] = swap;
+	      }
+	    numApplied++;
+	  }
+	else
+	  // delete the operator (we can't apply it for some reason)
+
+	  deleteOperator(&(batch[k]),&(splitQueue[batch[k].where]));
 
-	  applyOperator(&bestOperator,G);
-	 
-	  // update the gains
+      // update the gains (all at once)
  
-	  updateGainsAfterOperator(&bestOperator,G,maxIncoming,N);
+      updateGainsAfterOperators(batch,numApplied,G,splitQueue,maxIncoming,N);
 
-	  // merge will be processed separately (if used at all)
+      // merge will be processed separately (if used at all)
 
-	  if (params->allowMerge)
-	    recomputeDecisionGraphMergeGains(T[bestOperator.where],
-					     merge,
-					     &(numMerges[bestOperator.where]),
-					     bestOperator.where,
-					     N);
-	}
-      else
-	// delete the operator (we can't apply it for some reason)
+      if (params->allowMerge)
+	for (k=0; k<numApplied; k++)
+	  recomputeDecisionGraphMergeGains(T[batch[k].where],
+					   merge,
+					   mergeSize,
+					   &(numMerges[batch[k].where]),
+					   batch[k].where,
+					   N);
 
-	deleteOperator(&bestOperator);
+      // update the best operator in the nodes we've touched
 
-      // update the best operator in the node we've touched
+      for (k=0; k<numBatch; k++)
+	{
+	  where = batch[k].where;
+
+	  updateBestNodeOperator(&(bestNodeOperator[where]),
+				 T[where],
+				 &(splitQueue[where]),
+				 merge[where],
+				 numMerges[where],
+				 where);
+
+	  updateNodeQueue(&nodeQueue,where);
+	}
 
-      updateBestNodeOperator(&(bestNodeOperator[bestOperator.where]),
-			     T[bestOperator.where],
-			     merge[bestOperator.where],
-			     numMerges[bestOperator.where],
-			     bestOperator.where,
-			     n);
+      numRounds++;
+      numAppliedOperators += numApplied;
 
       // everything alright, now we must get the best gain again
       
       resetOperator(&bestOperator);
-      
-      for (i=0; i<n; i++)
-	updateBestOperator(&bestOperator,&(bestNodeOperator[i]));
+      updateBestOperator(&bestOperator,&(bestNodeOperator[getBestNode(&nodeQueue)]));
     };
 
   // free it all
@@ -207,8 +310,15 @@ int constructTheNetwork(AcyclicOrientedGraph *G,
   free(canAdd);
 
   free(bestNodeOperator);
+  Free(batch);
+
+  for (i=0; i<n; i++)
+    doneSplitQueue(&(splitQueue[i]));
+  Free(splitQueue);
+  doneNodeQueue(&nodeQueue);
 
   free(numMerges);
+  free(mergeSize);
   for (i=0; i<n; i++)
     if (merge[i]!=NULL)
       free(merge[i]);
@@ -239,84 +349,19 @@ int generateNewInstances(AcyclicOrientedGraph *G,
 			 Population *P,
 			BoaParams *params)
 {
-  long N;
-  int  n;
-  int *index;
-  
-  // assign the helper variables
-  
-  N = P->N;
-  n = P->n;
-
-  // allocate index for topological ordering
+  Sampler sampler;
 
-  index = (int*) Calloc(n,sizeof(int));
+  // compile the decision graphs into a flat sampler
 
-  // order the vertices topologically
-
-  topologicalOrdering(G,index);
+  compileSampler(&sampler,G,T);
 
   // generate the new stuff
 
-  for (long i=0; i<N; i++)
-    generateInstance(P->x[i],G,index,T);
+  sampleInstances(&sampler,P);
 
   // free memory
 
-  free(index);
-
-  // get back
-
-  return 0;
-}
-
-// ================================================================================
-//
-// name:          generateNewInstance
-//
-// function:      generates a new instance given the network and the decision 
-//                graphs
-//
-// parameters:    x........the instance (output)
-//                G........the network
-//                index....index containing the topological ordering of variables
-//                T........the decision graphs for each variable
-//
-// returns:       (int) 0
-//
-// ================================================================================
-
-int generateInstance(char *x,
-		     AcyclicOrientedGraph *G,
-		     int *index,
-		     FrequencyDecisionGraph **T)
-{
-    int i;
-  int n;
-  int position;
-  int value;
-  double p0,p1;
-
-  // assign the helper variables
-
-  n = G->size();
-
-  // generate the stuff
-
-  for (i=0; i<n; i++)
-    {
-      position = index[i];
-      T[position]->iteratorFollowInstanceFromRoot(x);
-      
-      p0 = T[position]->getIterator()->value[0];
-      p1 = T[position]->getIterator()->value[1];
-      p0 = p0/(p0+p1);
-      p1 = 1-p0;
-
-      value=(drand()<p1)? 1:0;
-
-      x[position]=value;
-    }
+  freeSampler(&sampler);
 
   // get back
 
@@ -419,105 +464,266 @@ int recomputeDecisionGraphSplitGains(FrequencyDecisionGraph *t,
 				     int n,
 				     long N)
 {
-  int    label;
+  // find the splits we can do and compute their gains
+
+  findSplitCandidates(t,x,G,maxParents,node,n);
+  computeSplitGains(t,x,N);
+
+  // get back
+  
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          findSplitCandidates
+//
+// function:      finds the splits we can do on a particular node of a decision
+//                graph (the label must not be our parent nor the node itself,
+//                and it must not create a cycle) and keeps them in the node in
+//                increasing order of the labels; only those get a gain computed
+//                (the array of the node is reused if it's big enough, otherwise
+//                a new one is taken from the memory of the graph, so this one
+//                must not run on more threads at a time)
+//
+// parameters:    t............the decision graph where the node is located
+//                x............the node we want to find the splits for
+//                G............the network
+//                maxParents...maximum number of parents of a node
+//                node.........which node this tree is for
+//                n............number of variables
+//
+// returns:       (int) the number of the splits
+//
+// ================================================================================
+
+int findSplitCandidates(FrequencyDecisionGraph *t,
+			LabeledTreeNode *x, 
+			AcyclicOrientedGraph *G,
+			int maxParents,
+			int node,
+			int n)
+{
+  int label;
+  int numCandidates;
+
+  x->numCandidates = 0;
+
+  // if this bit fixed now, or the depth is too big, we can't split
+
+  if ((x->value[0]<=FIXED_THRESHOLD)||(x->value[1]<=FIXED_THRESHOLD)||(x->depth>=maxParents))
+    return 0;
+
+  // count the splits we can do
+
+  numCandidates = 0;
+  for (label=0; label<n; label++)
+    if ((node!=label)&&
+	((x->parentLabels[label>>6]&(((uint64_t) 1)<<(label&63)))==0)&&
+	((G->connected(label,node))||
+	 ((G->getNumIn(node)<maxParents)&&(G->canAddEdge(label,node)))))
+      numCandidates++;
+
+  if (numCandidates==0)
+    return 0;
+
+  // get space for them, if there's not enough yet
+
+  if (numCandidates>x->candidateSize)
+    {
+      if (x->candidate)
+	t->freeMemory(x->candidate);
+
+      x->candidate     = (SplitCandidate*) t->allocateMemory(numCandidates*sizeof(SplitCandidate));
+      x->candidateSize = numCandidates;
+    }
+
+  // and put them in
+
+  for (label=0; label<n; label++)
+    if ((node!=label)&&
+	((x->parentLabels[label>>6]&(((uint64_t) 1)<<(label&63)))==0)&&
+	((G->connected(label,node))||
+	 ((G->getNumIn(node)<maxParents)&&(G->canAddEdge(label,node)))))
+      {
+	x->candidate[x->numCandidates].label = label;
+	x->candidate[x->numCandidates].gain  = -1;
+	x->numCandidates++;
+      }
+
+  // get back
+
+  return x->numCandidates;
+}
+
+// ================================================================================
+//
+// name:          computeSplitGains
+//
+// function:      computes the gains of the splits found on a node by
+//                findSplitCandidates (the graph is only read, so this one can
+//                run on different nodes at the same time)
+//
+// parameters:    t............the decision graph where the node is located
+//                x............the node we want to compute the gains for
+//                N............population size
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int computeSplitGains(FrequencyDecisionGraph *t, LabeledTreeNode *x, long N)
+{
+  int    c;
   double scoreBefore;
   double scoreAfter;
   double gain;
-  LabeledTreeNode *dummy;
-  double *leftValue0,*leftValue1;
-  double *rightValue0,*rightValue1;
+  LabeledTreeNode dummy(LEAF);
   double leftContribution;
   double rightContribution;
+  double stackFrequencies[4*MAX_STACK_CANDIDATES];
+  double *left0,*left1,*right0,*right1;
 
-  // if this bit fixed now, ignore it
+  if (x->numCandidates==0)
+    return 0;
 
-  if ((x->value[0]<=FIXED_THRESHOLD)||(x->value[1]<=FIXED_THRESHOLD))
-    {
-      for (label=0; label<n; label++)
-	x->dArrayTmp[label]=-1;
-      return 0;
-    };
+  // compute basic contribution of this node (before split)
+	
+  scoreBefore = nodeContribution(x,N);
+
+  // compute the frequencies of all the splits
+
+  if (x->numCandidates<=MAX_STACK_CANDIDATES)
+    left0 = stackFrequencies;
+  else
+    left0 = (double*) Calloc(4*x->numCandidates,sizeof(double));
 
-  // depth is too big - we can't split
+  left1  = left0+x->numCandidates;
+  right0 = left1+x->numCandidates;
+  right1 = right0+x->numCandidates;
 
-  if (x->depth>=maxParents)
+  t->computeSplitFrequencies(x,x->candidate,x->numCandidates,left0,left1,right0,right1);
+
+  // and their gains
+
+  for (c=0; c<x->numCandidates; c++)
     {
-      for (label=0; label<n; label++)
-	x->dArrayTmp[label]=-1;
-      return 0;
-    };
+      // compute frequencies if we did split
+      
+      dummy.value[0] = left0[c];
+      dummy.value[1] = left1[c];
+      leftContribution = nodeContribution(&dummy,N);
+      
+      dummy.value[0] = right0[c];
+      dummy.value[1] = right1[c];
+      rightContribution = nodeContribution(&dummy,N);
+      
+      // new contribution
+      
+      scoreAfter = leftContribution+rightContribution;
+      
+      // compute the gain
+      
+      gain = scoreAfter-scoreBefore-log2(double(N))/2;
+      
+      // update the contribution
+      
+      x->candidate[c].gain = gain;
+    }
 
-  // compute basic contribution of this node (before split)
-	
-	scoreBefore = nodeContribution(x,N);
+  if (left0!=stackFrequencies)
+    Free(left0);
+  
+  // get back
+  
+  return 0;
+}
 
-  // allocate memory for the frequencies of the splits
+// ================================================================================
+//
+// name:          recomputeSplitGainsInParallel
+//
+// function:      recomputes the split gains of a number of leaves on all threads
+//                (their splits are found first, one leaf after another; the
+//                network is only read, so it must not change meanwhile; the
+//                leaves must be different, they can be in the same graph)
+//
+// parameters:    numLeaves....the number of leaves
+//                t............the decision graph of each leaf
+//                x............the leaves
+//                node.........which node the graph of each leaf is for
+//                G............the network
+//                maxParents...maximum number of parents of a node
+//                n............number of variables
+//                N............population size
+//
+// returns:       (int) 0
+//
+// ================================================================================
 
-  leftValue0  = (double*) Calloc(n,sizeof(double));
-  leftValue1  = (double*) Calloc(n,sizeof(double));
-  rightValue0 = (double*) Calloc(n,sizeof(double));
-  rightValue1 = (double*) Calloc(n,sizeof(double));
+int recomputeSplitGainsInParallel(int numLeaves,
+				  FrequencyDecisionGraph **t,
+				  LabeledTreeNode **x,
+				  int *node,
+				  AcyclicOrientedGraph *G,
+				  int maxParents,
+				  int n,
+				  long N)
+{
+  SplitGainsTask task;
+  long           grain;
+  int            i;
 
-  // try all splits we can do (must not be our parent, and must not
-  // create a cycle)
+  // find the splits of all the leaves first (this takes memory from the graphs)
 
-  t->computeSplitFrequencies(x,leftValue0,leftValue1,rightValue0,rightValue1);
+  for (i=0; i<numLeaves; i++)
+    findSplitCandidates(t[i],x[i],G,maxParents,node[i],n);
 
-  // we'll need this dummy node
+  task.t = t;
+  task.x = x;
+  task.N = N;
 
-  dummy = new LabeledTreeNode(LEAF);
+  // a few chunks per thread, so that the leaves with more instances even out
 
-  for (label=0; label<n; label++)
-    {
-      if ((node!=label)&&
-      	  (x->parentLabelCoincidenceVector[label]==0)&&
-      	  ((G->connected(label,node))||
-	   ((G->getNumIn(node)<maxParents)&&(G->canAddEdge(label,node)))))
-      {
-	// compute frequencies if we did split
-	
-	dummy->value[0] = leftValue0[label];
-	dummy->value[1] = leftValue1[label];
-	leftContribution = nodeContribution(dummy,N);
+  grain = numLeaves/(getNumThreads()*SPLIT_GAINS_CHUNKS_PER_THREAD);
+  if (grain<1)
+    grain = 1;
 
-	dummy->value[0] = rightValue0[label];
-	dummy->value[1] = rightValue1[label];
-	rightContribution = nodeContribution(dummy,N);
+  parallelFor(numLeaves,grain,&recomputeSplitGains,&task);
 
-	// new contribution
-	
-	scoreAfter = leftContribution+rightContribution;
-	
-	// compute the gain
+  // get back
 
-	gain = scoreAfter-scoreBefore-log2(double(N))/2;
+  return 0;
+}
 
-	// update the contribution
+// ================================================================================
+//
+// name:          recomputeSplitGains
+//
+// function:      the parallel task recomputing the split gains of the leaves
+//                first...last-1
+//
+// parameters:    first........the first leaf
+//                last.........one past the last leaf
+//                thread.......the thread running the task (unused)
+//                data.........the task (SplitGainsTask)
+//
+// returns:       (int) 0
+//
+// ================================================================================
 
-	x->dArrayTmp[label]=gain;
+static int recomputeSplitGains(long first, long last, int thread, void *data)
+{
+  SplitGainsTask *task;
+  long i;
 
-	// update the values we computed (for future reference)
+  task = (SplitGainsTask*) data;
+
+  for (i=first; i<last; i++)
+    computeSplitGains(task->t[i],task->x[i],task->N);
 
-	x->rightValue0Array[label]=rightValue0[label];
-	x->rightValue1Array[label]=rightValue1[label];
-	x->leftValue0Array[label]=leftValue0[label];
-	x->leftValue1Array[label]=leftValue1[label];
-  }
-    else
-			x->dArrayTmp[label]= -1;
-  }
-  
-  // delete the dummy node
-  delete dummy;
-
-  // free the memory used by the frequencies of the splits
-  free(leftValue0);
-  free(leftValue1);
-  free(rightValue0);
-  free(rightValue1);
-  
   // get back
-  
+
   return 0;
 }
 
@@ -533,6 +739,8 @@ int recomputeDecisionGraphSplitGains(FrequencyDecisionGraph *t,
 //                G............the network
 //                merge........how the merge gains and operators really look like
 //                             (output)
+//                mergeSize....how many merge operators fit in merge[node] (the
+//                             array only grows, it is reused after each operator)
 //                numMerges....how many of those merge operators we did find
 //                n............number of variables
 //                N............population size
@@ -543,6 +751,7 @@ int recomputeDecisionGraphSplitGains(FrequencyDecisionGraph *t,
 
 int recomputeDecisionGraphMergeGains(FrequencyDecisionGraph *t,
 				     MergeOperator **merge,
+				     int *mergeSize,
 				     int *numMerges,
 				     int node,
 				     long N)
@@ -550,24 +759,26 @@ int recomputeDecisionGraphMergeGains(FrequencyDecisionGraph *t,
   double scoreBefore;
   double scoreAfter;
   double gain;
-  LabeledTreeNode *dummy;
+  LabeledTreeNode dummy(LEAF);
   NodeListItem *a, *b;
   int numLeaves;
 
-  // allocate a dummy node 
-
-  dummy = new LabeledTreeNode(LEAF);
-
   // assign helper variables
 
   numLeaves = t->getNumLeaves();
 
-  // allocate the merge operator array
+  // make sure the merge operator array is large enough (twice as large as
+  // needed then, the graph grows)
+
+  if (mergeSize[node]<numLeaves*(numLeaves+1)/2)
+    {
+      if (merge[node]!=NULL)
+	free(merge[node]);
+
+      mergeSize[node] = numLeaves*(numLeaves+1);
+      merge[node]     = (MergeOperator*) Calloc(mergeSize[node],sizeof(MergeOperator));
+    }
 
-  if (merge[node]!=NULL)
-    free(merge[node]);
-  
-  merge[node]   = (MergeOperator*) Calloc(numLeaves*(numLeaves+1)/2,sizeof(MergeOperator));
   *numMerges    = 0;
 
   // compute merge gains for all pair of nodes
@@ -582,12 +793,12 @@ int recomputeDecisionGraphMergeGains(FrequencyDecisionGraph *t,
 	// update the dummy node (its frequencies are equal the sum of the frequencies 
 	//                        of the two merged nodes)
 
-	dummy->value[0] = a->x->value[0]+b->x->value[0];
-	dummy->value[1] = a->x->value[1]+b->x->value[1];
+	dummy.value[0] = a->x->value[0]+b->x->value[0];
+	dummy.value[1] = a->x->value[1]+b->x->value[1];
 
 	// compute the score after the merge (without really having to do the merge)
 
-	scoreAfter = nodeContribution(dummy,N);
+	scoreAfter = nodeContribution(&dummy,N);
 
 	// compute the gain
 
@@ -605,10 +816,6 @@ int recomputeDecisionGraphMergeGains(FrequencyDecisionGraph *t,
 	  }
       }
 
-  // delete the dummy node
-
-  delete dummy;
-
   // get back
 
   return 0;
@@ -732,3 +939,39 @@ int doneMetric()
 
   return 0;
 }
+
+// ================================================================================
+//
+// name:          getModelBuildRounds
+//
+// function:      returns the number of rounds of all the model building so far
+//                (a round applies one or more operators, see modelBuildMode)
+//
+// parameters:    (none)
+//
+// returns:       (long) the number of rounds
+//
+// ================================================================================
+
+long getModelBuildRounds()
+{
+  return numRounds;
+}
+
+// ================================================================================
+//
+// name:          getModelBuildOperators
+//
+// function:      returns the number of operators applied in all the model
+//                building so far
+//
+// parameters:    (none)
+//
+// returns:       (long) the number of operators
+//
+// ================================================================================
+
+long getModelBuildOperators()
+{
+  return numAppliedOperators;
+}
@@ -21,11 +21,6 @@ int generateNewInstances(AcyclicOrientedGraph *G,
 			BoaParams *params);
 
 
-int generateInstance(char *x,
-		     AcyclicOrientedGraph *G,
-		     int *index,
-		     FrequencyDecisionGraph **T);
-
 int recomputeDecisionGraphSplitGains(FrequencyDecisionGraph *t,
 				     LabeledTreeNode *x, 
 				     AcyclicOrientedGraph *G,
@@ -34,8 +29,27 @@ int recomputeDecisionGraphSplitGains(FrequencyDecisionGraph *t,
 				     int n,
 				     long N);
 
+int findSplitCandidates(FrequencyDecisionGraph *t,
+			LabeledTreeNode *x, 
+			AcyclicOrientedGraph *G,
+			int maxParents,
+			int node,
+			int n);
+
+int computeSplitGains(FrequencyDecisionGraph *t, LabeledTreeNode *x, long N);
+
+int recomputeSplitGainsInParallel(int numLeaves,
+				  FrequencyDecisionGraph **t,
+				  LabeledTreeNode **x,
+				  int *node,
+				  AcyclicOrientedGraph *G,
+				  int maxParents,
+				  int n,
+				  long N);
+
 int recomputeDecisionGraphMergeGains(FrequencyDecisionGraph *t,
 				     MergeOperator **merge,
+				     int *mergeSize,
 				     int *numMerges,
 				     int node,
 				     long N);
@@ -48,4 +62,7 @@ double nodeContribution(LabeledTreeNode *x, long N);
 int initializeMetric(BoaParams *params);
 int doneMetric();
 
+long getModelBuildRounds();
+long getModelBuildOperators();
+
 #endif
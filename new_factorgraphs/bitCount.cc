@@ -0,0 +1,253 @@
+// ################################################################################
+//
+// name:          bitCount.cc
+//
+// purpose:       counting the ones in the intersections of bitsets (a column of
+//                the population with the strings in a leaf of a decision graph);
+//                the popcnt instruction or AVX2 are used when the processor has
+//                them (chosen at run time)
+//
+// ################################################################################
+
+#include <stdio.h>
+
+#include "bitCount.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BIT_COUNT_X86
+#include <immintrin.h>
+#endif
+
+static void scalarKernel(const uint64_t *bits, const uint64_t *a, const uint64_t *b, long numWords, long *countA, long *countB);
+
+#ifdef BIT_COUNT_X86
+static void popcntKernel(const uint64_t *bits, const uint64_t *a, const uint64_t *b, long numWords, long *countA, long *countB);
+static void avx2Kernel(const uint64_t *bits, const uint64_t *a, const uint64_t *b, long numWords, long *countA, long *countB);
+#endif
+
+// ---------------------
+// the kernel being used
+// ---------------------
+
+static BitCountKernel *kernel_=&scalarKernel;
+static const char     *kernelName_="scalar";
+
+// ================================================================================
+//
+// name:          selectBitCountKernel
+//
+// function:      chooses the kernel used by countAndBits (one the processor can't
+//                run falls back to the best one it can)
+//
+// parameters:    kernel.......the kernel (BIT_COUNT_...)
+//
+// returns:       (int) the kernel chosen
+//
+// ================================================================================
+
+int selectBitCountKernel(int kernel)
+{
+  int best;
+
+  best = BIT_COUNT_SCALAR;
+
+#ifdef BIT_COUNT_X86
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2"))
+    best = BIT_COUNT_AVX2;
+  else
+    if (__builtin_cpu_supports("popcnt"))
+      best = BIT_COUNT_POPCNT;
+#endif
+
+  if ((kernel==BIT_COUNT_AUTO)||(kernel>best))
+    kernel = best;
+
+  switch (kernel)
+    {
+#ifdef BIT_COUNT_X86
+    case BIT_COUNT_AVX2:
+      kernel_     = &avx2Kernel;
+      kernelName_ = "AVX2";
+      break;
+
+    case BIT_COUNT_POPCNT:
+      kernel_     = &popcntKernel;
+      kernelName_ = "popcnt";
+      break;
+#endif
+
+    default:
+      kernel      = BIT_COUNT_SCALAR;
+      kernel_     = &scalarKernel;
+      kernelName_ = "scalar";
+    }
+
+  // get back
+
+  return kernel;
+}
+
+// ================================================================================
+//
+// name:          getBitCountKernelName
+//
+// function:      returns the name of the kernel being used
+//
+// parameters:    (none)
+//
+// returns:       (const char*) the name
+//
+// ================================================================================
+
+const char *getBitCountKernelName()
+{
+  return kernelName_;
+}
+
+// ================================================================================
+//
+// name:          countAndBits
+//
+// function:      counts the ones in the intersection of a bitset with two other
+//                bitsets (the first one is read only once for both)
+//
+// parameters:    bits.........the bitset
+//                a............the first bitset to intersect it with
+//                b............the second bitset to intersect it with
+//                numWords.....the number of 64-bit words of each bitset
+//                countA.......the number of ones in (bits & a) (output)
+//                countB.......the number of ones in (bits & b) (output)
+//
+// returns:       (void)
+//
+// ================================================================================
+
+void countAndBits(const uint64_t *bits, const uint64_t *a, const uint64_t *b, long numWords, long *countA, long *countB)
+{
+  kernel_(bits,a,b,numWords,countA,countB);
+}
+
+// ================================================================================
+//
+// name:          scalarKernel
+//
+// function:      the kernel for any processor, one word at a time
+//
+// parameters:    (see countAndBits)
+//
+// returns:       (void)
+//
+// ================================================================================
+
+static void scalarKernel(const uint64_t *bits, const uint64_t *a, const uint64_t *b, long numWords, long *countA, long *countB)
+{
+  long i;
+  long ca,cb;
+
+  ca = cb = 0;
+
+  for (i=0; i<numWords; i++)
+    {
+      ca += __builtin_popcountll(bits[i]&a[i]);
+      cb += __builtin_popcountll(bits[i]&b[i]);
+    }
+
+  *countA = ca;
+  *countB = cb;
+}
+
+#ifdef BIT_COUNT_X86
+
+// ================================================================================
+//
+// name:          popcntKernel
+//
+// function:      the kernel using the popcnt instruction, one word at a time
+//
+// parameters:    (see countAndBits)
+//
+// returns:       (void)
+//
+// ================================================================================
+
+__attribute__((target("popcnt")))
+static void popcntKernel(const uint64_t *bits, const uint64_t *a, const uint64_t *b, long numWords, long *countA, long *countB)
+{
+  long i;
+  long ca,cb;
+
+  ca = cb = 0;
+
+  for (i=0; i<numWords; i++)
+    {
+      ca += __builtin_popcountll(bits[i]&a[i]);
+      cb += __builtin_popcountll(bits[i]&b[i]);
+    }
+
+  *countA = ca;
+  *countB = cb;
+}
+
+// ================================================================================
+//
+// name:          avx2Kernel
+//
+// function:      the kernel doing 4 words at once with AVX2 (the ones of each
+//                4 bits are looked up in a table by a byte shuffle and the bytes
+//                summed up into 64-bit counters)
+//
+// parameters:    (see countAndBits)
+//
+// returns:       (void)
+//
+// ================================================================================
+
+__attribute__((target("avx2,popcnt")))
+static void avx2Kernel(const uint64_t *bits, const uint64_t *a, const uint64_t *b, long numWords, long *countA, long *countB)
+{
+  long i;
+  long ca,cb;
+  __m256i table,low,x,y,zero,sumA,sumB;
+  uint64_t s[4];
+
+  table = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,
+			   0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+  low   = _mm256_set1_epi8(0x0f);
+  zero  = _mm256_setzero_si256();
+  sumA  = sumB = zero;
+
+  for (i=0; i+4<=numWords; i+=4)
+    {
+      x = _mm256_loadu_si256((const __m256i*) (bits+i));
+      y = _mm256_and_si256(x,_mm256_loadu_si256((const __m256i*) (a+i)));
+      x = _mm256_and_si256(x,_mm256_loadu_si256((const __m256i*) (b+i)));
+
+      y = _mm256_add_epi8(_mm256_shuffle_epi8(table,_mm256_and_si256(y,low)),
+			  _mm256_shuffle_epi8(table,_mm256_and_si256(_mm256_srli_epi16(y,4),low)));
+      x = _mm256_add_epi8(_mm256_shuffle_epi8(table,_mm256_and_si256(x,low)),
+			  _mm256_shuffle_epi8(table,_mm256_and_si256(_mm256_srli_epi16(x,4),low)));
+
+      sumA = _mm256_add_epi64(sumA,_mm256_sad_epu8(y,zero));
+      sumB = _mm256_add_epi64(sumB,_mm256_sad_epu8(x,zero));
+    }
+
+  _mm256_storeu_si256((__m256i*) s,sumA);
+  ca = s[0]+s[1]+s[2]+s[3];
+  _mm256_storeu_si256((__m256i*) s,sumB);
+  cb = s[0]+s[1]+s[2]+s[3];
+
+  // the words left
+
+  for (; i<numWords; i++)
+    {
+      ca += __builtin_popcountll(bits[i]&a[i]);
+      cb += __builtin_popcountll(bits[i]&b[i]);
+    }
+
+  *countA = ca;
+  *countB = cb;
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef _bitCount_h_
+#define _bitCount_h_
+
+#include <stdint.h>
+
+#define BIT_COUNT_AUTO   0  // the best one the processor can run
+#define BIT_COUNT_SCALAR 1
+#define BIT_COUNT_POPCNT 2  // one word at a time with the popcnt instruction
+#define BIT_COUNT_AVX2   3  // 4 words at once
+
+// counts the ones in (bits & a) and (bits & b) over numWords 64-bit words
+
+typedef void BitCountKernel(const uint64_t *bits, const uint64_t *a, const uint64_t *b, long numWords, long *countA, long *countB);
+
+int  selectBitCountKernel(int kernel);
+const char *getBitCountKernelName();
+
+void countAndBits(const uint64_t *bits, const uint64_t *a, const uint64_t *b, long numWords, long *countA, long *countB);
+
+#endif
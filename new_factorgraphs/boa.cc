@@ -18,6 +18,7 @@
 #include "boa.h"
 #include "population.h"
 #include "statistics.h"
+#include "runningStatistics.h"
 #include "replace.h"
 #include "select.h"
 #include "graph.h"
@@ -26,6 +27,10 @@
 #include "memalloc.h"
 #include "random.h"
 #include "frequencyDecisionGraph.h"
+#include "threadPool.h"
+#include "fitnessCache.h"
+#include "bitCount.h"
+#include "arena.h"
 #include "WindFarmLayout.h"
 #include "armadillo"
 
@@ -39,6 +44,15 @@ FILE *modelFile;
 
 BasicStatistics populationStatistics;
 
+// ------------------------------------------------------
+// the memory of the model (the decision graphs), given
+// back all at once after each generation
+// ------------------------------------------------------
+
+#define MODEL_ARENA_CHUNK (1<<20)
+
+Arena modelArena;
+
 // --------------------------------------------------------
 // the description of termination criteria that are checked
 // --------------------------------------------------------
@@ -69,6 +83,10 @@ int initialize(BoaParams *boaParams)
 
 	 char filename[200];
 
+  // start the threads
+
+  initializeThreadPool(boaParams->numThreads);
+
   // set the fitness function to be optimized
 
   setFitness(boaParams->fitnessNumber);
@@ -81,6 +99,19 @@ int initialize(BoaParams *boaParams)
 
   initializeMetric(boaParams);
 
+  // allocate the fitness cache
+
+  initializeFitnessCache(boaParams->fitnessCacheSize,boaParams->n);
+
+  // choose how the bits are counted when building the model
+
+  selectBitCountKernel(boaParams->bitCountKernel);
+  printf("Bit count kernel: %s\n",getBitCountKernelName());
+
+  // the model's memory
+
+  initializeArena(&modelArena,MODEL_ARENA_CHUNK);
+
   // reset the counter for fitness calls
 
   resetFitnessCalls();
@@ -131,6 +162,7 @@ int boa(BoaParams *boaParams)
   long       N,numOffspring,numParents,t;
   int        n;
   Population population,parents,offspring;
+  RunningStatistics runningStatistics;
   int        terminationReason;
 
   // set some variables
@@ -143,7 +175,7 @@ int boa(BoaParams *boaParams)
   // allocate the memory for the population
 
   allocatePopulation(&population,N,n);
-  allocatePopulation(&parents,numParents,n);
+  allocatePopulationView(&parents,numParents,n);
   allocatePopulation(&offspring,numOffspring,n);
 
   // randomly generate first population according to uniform distribution
@@ -154,13 +186,17 @@ int boa(BoaParams *boaParams)
 
   evaluatePopulation(&population);
 
+  // the statistics are kept up to date by the replacement from now on
+
+  initializeRunningStatistics(&runningStatistics,&population);
+
   // main loop
 
   t=0;
 
   // compute basic statistics on initial population
 
-  computeBasicStatistics(&populationStatistics,t,&population,boaParams);
+  computeBasicStatistics(&populationStatistics,t,&population,&runningStatistics,boaParams);
 
   // output the statistics on first generation
 
@@ -174,6 +210,10 @@ int boa(BoaParams *boaParams)
 
   while (!(terminationReason=terminationCriteria(boaParams)))
     {
+      // the random streams of this generation
+
+      setRandomGeneration(t);
+
       // perform truncation (block) selection
 
       selectTheBest(&population,&parents,boaParams);
@@ -188,7 +228,7 @@ int boa(BoaParams *boaParams)
 
       // replace the worst of the population with offspring
 
-      replaceWorst(&population,&offspring);
+      replaceWorst(&population,&offspring,&runningStatistics,boaParams);
       
       // increase the generation number
    
@@ -196,7 +236,7 @@ int boa(BoaParams *boaParams)
 
       // compute basic statistics
 
-      computeBasicStatistics(&populationStatistics,t,&population,boaParams);
+      computeBasicStatistics(&populationStatistics,t,&population,&runningStatistics,boaParams);
 
       // output the statistics on current generation
 
@@ -211,12 +251,15 @@ int boa(BoaParams *boaParams)
 
   // print out final statistics
 
-  computeBasicStatistics(&populationStatistics,t,&population,boaParams);
+  computeBasicStatistics(&populationStatistics,t,&population,&runningStatistics,boaParams);
   
   finalStatistics(stdout,terminationReasonDescription[terminationReason],&populationStatistics);
   finalStatistics(logFile,terminationReasonDescription[terminationReason],&populationStatistics);
   
-  // free the memory used by the population, the parents, and the offspring
+  // free the memory used by the statistics, the population, the parents, and
+  // the offspring
+
+  doneRunningStatistics(&runningStatistics);
 
   freePopulation(&population);
   freePopulation(&parents);
@@ -318,10 +361,17 @@ int generateOffspring(long t, Population *parents, Population *offspring, BoaPar
   
   T = (FrequencyDecisionGraph**) Calloc(parents->n,sizeof(FrequencyDecisionGraph*));
   
+  // the copies of a string are counted as one with a weight, so put the
+  // different ones first and pack them into bit columns for counting the
+  // frequencies
+
+  compressPopulation(parents);
+  packColumns(parents);
+
   // initialize the frequency trees
   
   for (k=0; k<parents->n; k++)
-    T[k] = new FrequencyDecisionGraph(parents,k);
+    T[k] = new FrequencyDecisionGraph(parents,k,&modelArena);
 
   // construct the Bayesian network to model the selected set of parents
 
@@ -348,6 +398,10 @@ int generateOffspring(long t, Population *parents, Population *offspring, BoaPar
 
   Free(T);
 
+  // give back the memory of the trees
+
+  resetArena(&modelArena);
+
   // get back
 
   return 0;
@@ -402,6 +456,18 @@ int done(BoaParams *boaParams)
 
   doneBasicStatistics(&populationStatistics);
 
+  // get rid of the fitness cache
+
+  doneFitnessCache();
+
+  // get rid of the model's memory
+
+  doneArena(&modelArena);
+
+  // stop the threads
+
+  doneThreadPool();
+
   // close output streams
 
   if (logFile)
@@ -468,3 +534,20 @@ FILE *getFitnessFile()
 {
   return fitnessFile;
 }
+
+// ================================================================================
+//
+// name:          getModelMemoryPeak
+//
+// function:      returns the maximal memory taken by the model in any generation
+//
+// parameters:    (none)
+//
+// returns:       (long) the number of bytes
+//
+// ================================================================================
+
+long getModelMemoryPeak()
+{
+  return getArenaPeak(&modelArena);
+}
@@ -7,12 +7,17 @@
 #define MAXOPTIMAL_TERMINATION      3
 #define OPTIMUMFOUND_TERMINATION    4
 
+#define MODEL_BUILD_GREEDY          0  // the best operator in each round
+#define MODEL_BUILD_BATCHED         1  // the best operator of each variable in each round
+
 #include "population.h"
 
 typedef struct {
 
   long N;                      // population size
   float percentOffspring;      // size of offspring (in %)
+  float percentElite;          // the best of the population never replaced (in %)
+  float maxReplacedPercent;    // the most of the population replaced in a generation (in %)
   
   int fitnessNumber;           // number of fitness function to use
   int n;                       // size of a problem (length of a string)
@@ -26,10 +31,20 @@ typedef struct {
 
   int   maxIncoming;           // maximal number of incoming edges in the networks
   char  allowMerge;            // allow the merge operator? (otherwise only splits are done)
+  int   modelBuildMode;        // how many operators are applied in a round (MODEL_BUILD_...)
 
   char *outputFilename;        // the name of ouput file
   float guidanceThreshold;     // the threshold for guidance in statistic info
 
+  int  wakeTableMode;          // wake interaction table for the wind farm layout (0=none, 1=sites, 2=offsets)
+  int  wakeOverlapMode;        // rotor-wake overlap (0=sampled, 1=segment, 2=disc area)
+  float windRoseMaxError;      // max. change of the efficiency by dropping bins of the wind rose (0 = keep all)
+  int  deficitKernel;          // kernel summing the wake deficits (DEFICIT_KERNEL_..., 0 = the best one)
+
+  int  numThreads;             // number of threads for the evaluation and model building (0 = one per processor)
+  long fitnessCacheSize;       // number of strings in the fitness cache (0 = no cache)
+  int  bitCountKernel;         // kernel counting the bits in model building (BIT_COUNT_..., 0 = the best one)
+
   char pause;                  // wait for enter after printing out generation statistics?
 
   long randSeed;               // random seed
@@ -49,4 +64,6 @@ FILE *getLogFile();
 FILE *getModelFile();
 FILE *getFitnessFile();
 
+long getModelMemoryPeak();
+
 #endif
@@ -0,0 +1,509 @@
+// ################################################################################
+//
+// name:          checkWake.cc
+//
+// purpose:       the checks of the faster ways of evaluating the wind farm layouts
+//                against the straightforward ones (run by make check); each check
+//                prints the largest difference it has found and the program exits
+//                with a non-zero code if any of them is out of the tolerance; the
+//                original wake geometry (with the angles to the edges of the wake
+//                cone) lives here as the reference for computeWakeGeometry
+//
+// ################################################################################
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "WindFarmLayout.h"
+#include "WakeInteractionTable.h"
+#include "IncrementalLayoutEvaluator.h"
+#include "random.h"
+#include "memalloc.h"
+
+// ---------------------------------------------
+// the siting grid of the wind farm layout problem
+// (the same as in fitness.cc)
+// ---------------------------------------------
+
+#define CHECK_GRID_SITES   100
+#define CHECK_GRID_COLUMNS 10
+#define CHECK_GRID_SPACING 300
+#define CHECK_NUM_TURBINES 30
+
+// ---------------------------------------------
+// a grid too large for a table of the site pairs
+// ---------------------------------------------
+
+#define CHECK_LARGE_GRID_SITES   1600
+#define CHECK_LARGE_GRID_COLUMNS 40
+
+// ---------------------------------------------
+// the number of random moves and the tolerance of
+// the efficiency (in %)
+// ---------------------------------------------
+
+#define CHECK_NUM_MOVES          2000
+#define CHECK_EFFICIENCY_EPSILON 1E-8
+
+// ---------------------------------------------
+// the number of random layouts on the grid the
+// wake geometry is checked on and the tolerance
+// of the distances
+// ---------------------------------------------
+
+#define CHECK_NUM_LAYOUTS        4
+#define CHECK_DISTANCE_EPSILON   1E-9
+
+static int checkWakeGeometry(WindFarmLayout *layout, const arma::vec &coordinates, const char *name);
+static int checkIncrementalEvaluator(WindFarmLayout *layout, WakeInteractionTable *table, int numSites, int gridColumns, const char *name);
+
+static int randomLayout(int *sites, char *used, int numSites);
+static int gridCoordinates(const int *sites, int numT, int gridColumns, arma::vec &coordinates);
+static void referenceWakeGeometry(const WindFarmLayout *layout, const arma::vec &someTurbineCoordinates, double theta, double a, arma::mat &overlap, arma::mat &distance);
+
+// ================================================================================
+//
+// name:          main
+//
+// function:      reads the wind farm in input/ and runs all the checks on it
+//
+// parameters:    argc.........the number of arguments (unused)
+//                argv.........the arguments (unused)
+//
+// returns:       (int) 0 if all the checks pass, 1 otherwise
+//
+// ================================================================================
+
+int main(int argc, char **argv)
+{
+  int  i,k;
+  int  failed;
+  int  sites[CHECK_NUM_TURBINES];
+  char used[CHECK_GRID_SITES];
+  char name[100];
+  arma::vec coordinates;
+
+  WindFarmLayout layout("input/init_layout.out","input/turbine_coordinates.in","input/wrf_test.rsf",
+			"input/coordinates","input/windDirections","input/windSpeeds",
+			"input/windProbabilities","input/turbineHeights","input/CtTable",
+			"input/rotorDiameters","input/roughnessLength","input/powerTable");
+
+  failed = 0;
+  setSeed(1);
+
+  // the wake geometry (the original one only samples the overlap) on the
+  // layouts of input/ and on random layouts on the grid
+
+  layout.setOverlapMode(WAKE_OVERLAP_SAMPLED);
+
+  failed |= checkWakeGeometry(&layout,layout.coordinates,"input/coordinates");
+
+  layout.readWindFarmLayoutFile();
+  for (i=0; i<(int) layout.constraints_coordinates.n_rows; i++)
+    sites[i] = (int) layout.constraints_coordinates(i,0)*CHECK_GRID_COLUMNS+(int) layout.constraints_coordinates(i,1);
+
+  gridCoordinates(sites,layout.constraints_coordinates.n_rows,CHECK_GRID_COLUMNS,coordinates);
+  failed |= checkWakeGeometry(&layout,coordinates,"input/init_layout.out");
+
+  for (k=0; k<CHECK_NUM_LAYOUTS; k++)
+    {
+      randomLayout(sites,used,CHECK_GRID_SITES);
+      gridCoordinates(sites,CHECK_NUM_TURBINES,CHECK_GRID_COLUMNS,coordinates);
+
+      sprintf(name,"random layout %i",k);
+      failed |= checkWakeGeometry(&layout,coordinates,name);
+    }
+
+  // the incremental evaluator against the whole layouts evaluated by the wind
+  // farm, with the wake geometry, with the tables (both kinds) and on a grid
+  // too large for a table
+
+  failed |= checkIncrementalEvaluator(&layout,NULL,CHECK_GRID_SITES,CHECK_GRID_COLUMNS,"wake geometry");
+
+  WakeInteractionTable siteTable(&layout,CHECK_GRID_SITES,CHECK_GRID_COLUMNS,CHECK_GRID_SPACING,TABLE_MODE_SITES);
+  failed |= checkIncrementalEvaluator(&layout,&siteTable,CHECK_GRID_SITES,CHECK_GRID_COLUMNS,"site pairs");
+
+  WakeInteractionTable offsetTable(&layout,CHECK_GRID_SITES,CHECK_GRID_COLUMNS,CHECK_GRID_SPACING,TABLE_MODE_OFFSET);
+  failed |= checkIncrementalEvaluator(&layout,&offsetTable,CHECK_GRID_SITES,CHECK_GRID_COLUMNS,"grid offsets");
+
+  failed |= checkIncrementalEvaluator(&layout,NULL,CHECK_LARGE_GRID_SITES,CHECK_LARGE_GRID_COLUMNS,"large grid");
+
+  // and with turbines that differ (the table doesn't fit them, so it must
+  // not be used)
+
+  for (i=0; i<CHECK_NUM_TURBINES; i++)
+    {
+      layout.DRot(i)       *= 1+0.1*(i%3);
+      layout.wakeSpread(i) *= 1+0.05*(i%4);
+    }
+
+  failed |= checkIncrementalEvaluator(&layout,&siteTable,CHECK_GRID_SITES,CHECK_GRID_COLUMNS,"different turbines");
+
+  // get back
+
+  if (failed)
+    printf("FAILED\n");
+  else
+    printf("OK\n");
+
+  return failed;
+}
+
+// ================================================================================
+//
+// name:          checkWakeGeometry
+//
+// function:      compares the overlaps and the distances computed by the wake
+//                geometry with those of the reference for all the directions and
+//                all the speed bins of each (with the axial induction of the bin);
+//                the turbines standing on the same spot are skipped, the reference
+//                puts their sample points right on the edges of the cone and its
+//                overlap is down to rounding there
+//
+// parameters:    layout.......the wind farm
+//                coordinates..the coordinates of the turbines (x's, then y's)
+//                name.........the name of the layout (for the output)
+//
+// returns:       (int) 0 if they agree, 1 otherwise
+//
+// ================================================================================
+
+static int checkWakeGeometry(WindFarmLayout *layout, const arma::vec &coordinates, const char *name)
+{
+  unsigned w,l;
+  unsigned i,j;
+  unsigned numT;
+  double   a;
+  double   maxOverlap,maxDistance;
+
+  numT = coordinates.n_elem/2;
+
+  arma::mat overlap(numT,numT),referenceOverlap(numT,numT);
+  arma::mat distance(numT,numT),referenceDistance(numT,numT);
+
+  maxOverlap  = 0;
+  maxDistance = 0;
+
+  for (w=0; w<layout->windDirections.n_elem; w++)
+    for (l=0; l<layout->binsPerDirection[w]; l++)
+      {
+	a = layout->binInduction(l,w);
+
+	layout->computeWakeGeometry(coordinates,layout->windDirections(w),a,overlap,distance);
+	referenceWakeGeometry(layout,coordinates,layout->windDirections(w),a,referenceOverlap,referenceDistance);
+
+	for (i=0; i<numT; i++)
+	  for (j=0; j<numT; j++)
+	    {
+	      if ((coordinates(i)==coordinates(j))&&(coordinates(i+numT)==coordinates(j+numT)))
+		continue;
+
+	      if (fabs(overlap(i,j)-referenceOverlap(i,j))>maxOverlap)
+		maxOverlap = fabs(overlap(i,j)-referenceOverlap(i,j));
+	      if (fabs(distance(i,j)-referenceDistance(i,j))>maxDistance)
+		maxDistance = fabs(distance(i,j)-referenceDistance(i,j));
+	    }
+      }
+
+  printf("Wake geometry (%s): largest overlap error %g, largest distance error %g\n",name,maxOverlap,maxDistance);
+
+  // get back
+
+  return ((maxOverlap>0)||(maxDistance>CHECK_DISTANCE_EPSILON));
+}
+
+// ================================================================================
+//
+// name:          checkIncrementalEvaluator
+//
+// function:      moves the turbines of a random layout one at a time to random
+//                free sites and compares the efficiency the incremental evaluator
+//                gets for each move (both before and after it's applied) with
+//                that of the whole layout evaluated by the wind farm; the moves
+//                of a turbine that doesn't exist, to a site off the grid and to a
+//                taken site must be rejected and leave the layout as it is
+//
+// parameters:    layout.......the wind farm
+//                table........the table of wake interactions for the evaluator
+//                             (NULL for none)
+//                numSites.....the number of the sites of the grid
+//                gridColumns..the number of the columns of the grid
+//                name.........the name of the check (for the output)
+//
+// returns:       (int) 0 if all the moves agree, 1 otherwise
+//
+// ================================================================================
+
+static int checkIncrementalEvaluator(WindFarmLayout *layout, WakeInteractionTable *table, int numSites, int gridColumns, const char *name)
+{
+  int    k;
+  int    turbine;
+  int    site;
+  int    sites[CHECK_NUM_TURBINES];
+  int    numAccepted;
+  char   *used;
+  double predicted,applied,reference;
+  double efficiency;
+  double maxError;
+  arma::vec coordinates;
+  FarmPowerResult result;
+  IncrementalLayoutEvaluator evaluator(layout,numSites,gridColumns,CHECK_GRID_SPACING,table);
+
+  used = (char*) Calloc(numSites,sizeof(char));
+
+  // a random layout to start with
+
+  randomLayout(sites,used,numSites);
+  gridCoordinates(sites,CHECK_NUM_TURBINES,gridColumns,coordinates);
+
+  reference = layout->evaluateLayout(coordinates,&result);
+  maxError  = fabs(evaluator.setLayout(sites,CHECK_NUM_TURBINES)-reference);
+
+  // and the moves
+
+  numAccepted = 0;
+
+  for (k=0; k<CHECK_NUM_MOVES; k++)
+    {
+      turbine = intRand(CHECK_NUM_TURBINES);
+
+      // the invalid ones first
+
+      efficiency = evaluator.farmEfficiency;
+
+      if (evaluator.evaluateMove(CHECK_NUM_TURBINES,0,NULL)>=0)
+	numAccepted++;
+      if (evaluator.evaluateMove(turbine,numSites,NULL)>=0)
+	numAccepted++;
+      if (evaluator.applyMove(turbine,-1)>=0)
+	numAccepted++;
+      if (evaluator.applyMove(turbine,sites[(turbine+1)%CHECK_NUM_TURBINES])>=0)
+	numAccepted++;
+      if (evaluator.applyMove(turbine,sites[turbine])>=0)
+	numAccepted++;
+
+      if (evaluator.farmEfficiency!=efficiency)
+	numAccepted++;
+
+      // and a valid one
+
+      do
+	site = intRand(numSites);
+      while (used[site]);
+
+      predicted = evaluator.evaluateMove(turbine,site,NULL);
+      applied   = evaluator.applyMove(turbine,site);
+
+      used[sites[turbine]] = 0;
+      used[site]           = 1;
+      sites[turbine]       = site;
+
+      gridCoordinates(sites,CHECK_NUM_TURBINES,gridColumns,coordinates);
+      reference = layout->evaluateLayout(coordinates,&result);
+
+      if (fabs(predicted-reference)>maxError)
+	maxError = fabs(predicted-reference);
+      if (fabs(applied-reference)>maxError)
+	maxError = fabs(applied-reference);
+    }
+
+  printf("Incremental evaluator (%s): %i moves, largest efficiency error %g %%, %i invalid moves accepted\n",name,CHECK_NUM_MOVES,maxError,numAccepted);
+
+  // free the memory
+
+  Free(used);
+
+  // get back
+
+  return ((maxError>CHECK_EFFICIENCY_EPSILON)||(numAccepted>0));
+}
+
+// ================================================================================
+//
+// name:          randomLayout
+//
+// function:      puts the turbines on different sites of the grid at random
+//
+// parameters:    sites........the site of each turbine (output)
+//                used.........whether each site is taken (output)
+//                numSites.....the number of the sites of the grid
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int randomLayout(int *sites, char *used, int numSites)
+{
+  int i,k;
+  int site;
+
+  for (k=0; k<numSites; k++)
+    used[k] = 0;
+
+  for (i=0; i<CHECK_NUM_TURBINES; i++)
+    {
+      do
+	site = intRand(numSites);
+      while (used[site]);
+
+      used[site] = 1;
+      sites[i]   = site;
+    }
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          gridCoordinates
+//
+// function:      computes the coordinates of the turbines on the sites of the grid
+//                (the same way as the wind farm fitness does)
+//
+// parameters:    sites........the site of each turbine
+//                numT.........the number of the turbines
+//                gridColumns..the number of the columns of the grid
+//                coordinates..the coordinates (x's, then y's, output)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int gridCoordinates(const int *sites, int numT, int gridColumns, arma::vec &coordinates)
+{
+  int i;
+
+  coordinates.set_size(2*numT);
+
+  for (i=0; i<numT; i++)
+    {
+      coordinates(i)      = (sites[i]/gridColumns)*CHECK_GRID_SPACING;
+      coordinates(i+numT) = (sites[i]%gridColumns)*CHECK_GRID_SPACING;
+    }
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          referenceWakeGeometry
+//
+// function:      the original geometry stage of the wind farm evaluation, working
+//                with the angles between the sample points and the edges of the
+//                wake cone in the x/y frame (the reference for computeWakeGeometry
+//                with the sampled overlap)
+//
+// parameters:    layout.......the wind farm
+//                someTurbineCoordinates...the coordinates of the turbines
+//                theta........the wind direction
+//                a............the axial induction (for the Ct-dependent radius)
+//                overlap......the fraction of the rotor of i in the wake of j
+//                             (output)
+//                distance.....the stream-wise distance from j to i (output)
+//
+// returns:       (void)
+//
+// ================================================================================
+
+static void referenceWakeGeometry(const WindFarmLayout *layout, const arma::vec &someTurbineCoordinates, double theta, double a, arma::mat &overlap, arma::mat &distance)
+{
+
+	unsigned numT = someTurbineCoordinates.n_elem / 2;
+
+	for (unsigned i = 0; i < numT; i++) {
+		// dromero
+		// use a turbine-specific rotor diameter
+		double r0i = layout->DRot(i) / 2;
+
+		for (unsigned j = 0; j < numT; j++) {
+			/*
+			 \      /
+			 \  * /<-- centre of turbine i
+			 \__/ <-- turbine j
+			 \/
+			 */
+			overlap(i, j) = 0;
+			distance(i, j) = (someTurbineCoordinates(i)
+					- someTurbineCoordinates(j)) * cos(theta)
+					+ (someTurbineCoordinates(i + numT)
+							- someTurbineCoordinates(j + numT))
+							* sin(theta);
+
+			if (i == j)
+				continue;
+
+			// dromero
+			// calculates wake expansion angle based on this turbine's height
+			double alpha = 0.5 / log(layout->Z(j) / layout->Z0(j));
+			double al = atan(alpha); //half angle of the wake spread
+			double r = layout->wakeRadius(layout->DRot(j) / 2, a);
+
+			vec pt1(2); // coordinates of the "left" end of initial wake cone
+			vec pt2(2); // coordinates of the "right" end of initial wake cone
+			pt1(0) = someTurbineCoordinates(j)
+					+ r * cos(theta + PI / 2);
+			pt2(0) = someTurbineCoordinates(j)
+					+ r * cos(theta - PI / 2);
+			pt1(1) = someTurbineCoordinates(j + numT)
+					+ r * sin(theta + PI / 2);
+			pt2(1) = someTurbineCoordinates(j + numT)
+					+ r * sin(theta - PI / 2);
+
+			vec pt3(2); // coordinates of the "left" end of turbine i
+			vec pt4(2); // coordinates of the "right" end of turbine i
+			pt3(0) = someTurbineCoordinates(i)
+					+ r0i * cos(theta + PI / 2);
+			pt4(0) = someTurbineCoordinates(i)
+					+ r0i * cos(theta - PI / 2);
+			pt3(1) = someTurbineCoordinates(i + numT)
+					+ r0i * sin(theta + PI / 2);
+			pt4(1) = someTurbineCoordinates(i + numT)
+					+ r0i * sin(theta - PI / 2);
+
+			int num_dtPoints = 10;
+			vec dtPointsInWake = zeros(num_dtPoints);
+			for (int s = 0; s < num_dtPoints; s++) {
+				vec dtPoint(2); // one point on the rotor of downstream turbine i
+				dtPoint(0) = (pt3(0) - pt4(0)) * s
+						/ num_dtPoints + pt4(0);
+				dtPoint(1) = (pt3(1) - pt4(1)) * s
+						/ num_dtPoints + pt4(1);
+				vec r1(2); //vector pointing from pt1 to the point on turbine i
+				vec r2(2);
+				r1(0) = dtPoint(0) - pt1(0);
+				r1(1) = dtPoint(1) - pt1(1);
+				r2(0) = dtPoint(0) - pt2(0);
+				r2(1) = dtPoint(1) - pt2(1);
+
+				vec r1_hat = r1 / norm(r1, 2); // normalized r1
+				vec r2_hat = r2 / norm(r2, 2);
+
+				double halfangle = (al + PI / 2) / 2;
+
+				vec pt1_c(2); // centre line at pt1 between wake left boundary and turbine
+				vec pt2_c(2);
+				pt1_c(0) = cos(theta - PI / 2 + halfangle);
+				pt1_c(1) = sin(theta - PI / 2 + halfangle);
+				pt2_c(0) = cos(theta + PI / 2 - halfangle);
+				pt2_c(1) = sin(theta + PI / 2 - halfangle);
+
+				if (pt1_c(0) * r1_hat(0) + pt1_c(1) * r1_hat(1)
+						>= cos(halfangle)
+						&& pt2_c(0) * r2_hat(0)
+								+ pt2_c(1) * r2_hat(1)
+								>= cos(halfangle))
+								//if (dot(pt1_c, r1_hat) >= cos(halfangle) && dot(pt2_c, r2_hat) >= cos(halfangle))
+										{
+					dtPointsInWake(s) = 1;
+				}
+			}
+			overlap(i, j) = (double) sum(dtPointsInWake)
+					/ num_dtPoints;
+		}
+	}
+}
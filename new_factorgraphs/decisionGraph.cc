@@ -13,6 +13,8 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <new>
 
 #include "decisionGraph.h"
 #include "memalloc.h"
@@ -26,17 +28,20 @@
 //
 // function:      constructor
 //
-// parameters:    (none)
+// parameters:    arena....the arena to allocate the graph in (NULL = use the
+//                         heap); the graph must be gone before it is reset
 //
 // returns:       void
 //
 // ================================================================================
 
-DecisionGraph::DecisionGraph()
+DecisionGraph::DecisionGraph(Arena *arena)
 {
+  this->arena = arena;
+
   // create the root node
 
-  root = new LabeledTreeNode(LEAF);
+  root = newNode();
   
   // one leaf at the moment (the root)
 
@@ -44,8 +49,9 @@ DecisionGraph::DecisionGraph()
 
   // add the root to the list of leaf nodes
 
-  leaves           = new NodeListItem;
+  leaves           = (NodeListItem*) allocateMemory(sizeof(NodeListItem));
   leaves->x        = root;
+  leaves->order    = 0;
   leaves->previous = leaves->next = NULL;
 
   // add pointer to the root's item in the leaf list to the root
@@ -72,10 +78,96 @@ DecisionGraph::DecisionGraph()
 
 DecisionGraph::~DecisionGraph()
 {
+  // the nodes in an arena go with it
+
+  if (arena!=NULL)
+    return;
+
   deleteSubtree(root);
   deleteNodeList(leaves);
 }
 
+// ================================================================================
+//
+// name:          DecisionGraph::allocateMemory
+//
+// function:      allocates a zeroed block of memory for the graph (in its arena
+//                if it's got one)
+//
+// parameters:    size....the size of the block
+//
+// returns:       (void*) the block
+//
+// ================================================================================
+
+void *DecisionGraph::allocateMemory(long size)
+{
+  if (arena)
+    return arenaAlloc(arena,size);
+  else
+    return Calloc(size,1);
+}
+
+// ================================================================================
+//
+// name:          DecisionGraph::freeMemory
+//
+// function:      frees a block allocated by allocateMemory (the blocks in an arena
+//                are freed when it's reset)
+//
+// parameters:    x.......the block
+//
+// returns:       (void)
+//
+// ================================================================================
+
+void DecisionGraph::freeMemory(void *x)
+{
+  if (arena==NULL)
+    Free(x);
+}
+
+// ================================================================================
+//
+// name:          DecisionGraph::newNode
+//
+// function:      creates a new leaf (in the arena if the graph has got one)
+//
+// parameters:    (none)
+//
+// returns:       (LabeledTreeNode*) the new node
+//
+// ================================================================================
+
+LabeledTreeNode *DecisionGraph::newNode()
+{
+  if (arena==NULL)
+    return new LabeledTreeNode(LEAF);
+  else
+    return new (arenaAlloc(arena,sizeof(LabeledTreeNode))) LabeledTreeNode(LEAF);
+}
+
+// ================================================================================
+//
+// name:          DecisionGraph::deleteNode
+//
+// function:      deletes a node created by newNode (the nodes in an arena are
+//                left to it, together with all their memory)
+//
+// parameters:    x.......the node
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int DecisionGraph::deleteNode(LabeledTreeNode *x)
+{
+  if (arena==NULL)
+    delete x;
+
+  return 0;
+}
+
 // ================================================================================
 //
 // name:          DecisionGraph::deleteSubtree
@@ -115,11 +207,11 @@ int DecisionGraph::deleteSubtree(LabeledTreeNode *x)
     }
 
   if (x->parent)
-    free(x->parent);
+    freeMemory(x->parent);
 
   // delete the node itself
 
-  delete x;
+  deleteNode(x);
 
   // get back
 
@@ -144,7 +236,7 @@ int DecisionGraph::deleteNodeList(NodeListItem *x)
     return 0;
 
   deleteNodeList(x->next);
-  delete x;
+  freeMemory(x);
 
   return 0;
 }
@@ -232,16 +324,16 @@ int DecisionGraph::split(LabeledTreeNode *x, int label)
 
   // split the node
 
-  x->left  = new LabeledTreeNode(LEAF);
-  x->right = new LabeledTreeNode(LEAF);
+  x->left  = newNode();
+  x->right = newNode();
 
   // allocate a parent for each of the children
 
   x->left->numParents=1;
-  x->left->parent = (LabeledTreeNode**) malloc(sizeof(LabeledTreeNode*));
+  x->left->parent = (LabeledTreeNode**) allocateMemory(sizeof(LabeledTreeNode*));
 
   x->right->numParents=1;
-  x->right->parent = (LabeledTreeNode**) malloc(sizeof(LabeledTreeNode*));
+  x->right->parent = (LabeledTreeNode**) allocateMemory(sizeof(LabeledTreeNode*));
 
   // assign the parent
   
@@ -278,18 +370,22 @@ int DecisionGraph::merge(LabeledTreeNode *x, LabeledTreeNode *y)
   int i,j,k;
   int newParents;
   int found;
+  LabeledTreeNode **parent;
 
   // update the leaf list
 
   updateLeavesBeforeMerge(x,y);
 
-  // redirect the y's parents to x instead of y
+  // redirect the y's parents to x instead of y (both edges of a parent can lead
+  // to y, when y was merged with its sibling before)
 
   for (i=0; i<y->numParents; i++)
-    if (y->parent[i]->left==y)
-      y->parent[i]->left=x;
-    else
-      y->parent[i]->right=x;
+    {
+      if (y->parent[i]->left==y)
+	y->parent[i]->left=x;
+      if (y->parent[i]->right==y)
+	y->parent[i]->right=x;
+    }
   
   // assign all parents from y to x (only those that are new to x)
 
@@ -305,7 +401,10 @@ int DecisionGraph::merge(LabeledTreeNode *x, LabeledTreeNode *y)
 	newParents++;
     };
 
-  x->parent=(LabeledTreeNode**) realloc(x->parent,(x->numParents+newParents)*sizeof(LabeledTreeNode*));
+  parent = (LabeledTreeNode**) allocateMemory((x->numParents+newParents)*sizeof(LabeledTreeNode*));
+  memcpy(parent,x->parent,x->numParents*sizeof(LabeledTreeNode*));
+  freeMemory(x->parent);
+  x->parent = parent;
 
   k=x->numParents;
   for (i=0; i<y->numParents; i++)
@@ -356,7 +455,7 @@ int DecisionGraph::updateLeavesAfterSplit(LabeledTreeNode *x)
 
   // create a new list item and insert it between item and item->next
 
-  newItem = new NodeListItem;
+  newItem = (NodeListItem*) allocateMemory(sizeof(NodeListItem));
  
   if (item->next)
     item->next->previous = newItem;     // redirect the right neighbour
@@ -374,6 +473,17 @@ int DecisionGraph::updateLeavesAfterSplit(LabeledTreeNode *x)
 
   numLeaves++;
 
+  // the new item goes halfway between its neighbours in the order (renumber
+  // all the items if there's no room left between them)
+
+  if (newItem->next)
+    newItem->order = item->order+(newItem->next->order-item->order)/2;
+  else
+    newItem->order = item->order+(ULLONG_MAX-item->order)/2;
+
+  if (newItem->order==item->order)
+    renumberLeaves();
+
   // x's got no items in the list anymore
 
   x->leavesItem = NULL;
@@ -383,6 +493,34 @@ int DecisionGraph::updateLeavesAfterSplit(LabeledTreeNode *x)
   return 0;
 }
 
+// ================================================================================
+//
+// name:          DecisionGraph::renumberLeaves
+//
+// function:      spreads the order of the items in the list of leaves evenly
+//
+// parameters:    (none)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int DecisionGraph::renumberLeaves()
+{
+  NodeListItem *item;
+  unsigned long long step;
+  unsigned long long order;
+
+  step = ULLONG_MAX/(numLeaves+1);
+
+  for (item=leaves, order=0; item; item=item->next, order+=step)
+    item->order = order;
+
+  // get back
+
+  return 0;
+}
+
 // ================================================================================
 //
 // name:          DecisionGraph::updateLeavesBeforeMerge
@@ -421,7 +559,7 @@ int DecisionGraph::updateLeavesBeforeMerge(LabeledTreeNode *x, LabeledTreeNode *
   if (yItem==leaves)
     leaves=yItem->next;
 
-  Free(yItem);
+  freeMemory(yItem);
 
   // decrement the number of leaves
 
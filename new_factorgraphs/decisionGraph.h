@@ -4,6 +4,7 @@
 #include <stdio.h>
 
 #include "labeledTreeNode.h"
+#include "arena.h"
 
 #define LEAF  0
 #define SPLIT 1
@@ -13,6 +14,8 @@
 struct NodeListItem {
   LabeledTreeNode *x;
 
+  unsigned long long order;  // increases along the list (to compare positions)
+
   NodeListItem *previous;
   NodeListItem *next;
 };
@@ -22,6 +25,8 @@ struct NodeListItem {
 class DecisionGraph {
 
  private:
+  Arena           *arena;       // where the nodes live (NULL = on the heap)
+
   LabeledTreeNode *root;
 
   int              numLeaves;
@@ -35,15 +40,21 @@ class DecisionGraph {
 
   int updateLeavesAfterSplit(LabeledTreeNode *x);
   int updateLeavesBeforeMerge(LabeledTreeNode *x, LabeledTreeNode *y);
+  int renumberLeaves();
 
  protected:
   LabeledTreeNode *newNode();
   int deleteNode(LabeledTreeNode *x);
 
  public:
-  DecisionGraph();
+  DecisionGraph(Arena *arena=NULL);
   virtual ~DecisionGraph();
 
+  // memory for the nodes and the stuff in them
+
+  void  *allocateMemory(long size);
+  void   freeMemory(void *x);
+
   // get the root
 
   LabeledTreeNode *getRoot();
@@ -0,0 +1,248 @@
+// ################################################################################
+//
+// name:          deficitKernel.cc
+//
+// purpose:       the sums of squared wake deficits over the speed bins of a wind
+//                direction; the bins of a turbine are stored next to each other, so
+//                that the bins are done several at once with AVX2 or AVX-512 when
+//                the processor has them (chosen at run time)
+//
+// ################################################################################
+
+#include <stdio.h>
+
+#include "deficitKernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DEFICIT_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+static void scalarKernel(const double *induction, int numBins, const double *shrink, const double *overlap, int numSources, double *sumSqr);
+
+#ifdef DEFICIT_KERNEL_X86
+static void avx2Kernel(const double *induction, int numBins, const double *shrink, const double *overlap, int numSources, double *sumSqr);
+static void avx512Kernel(const double *induction, int numBins, const double *shrink, const double *overlap, int numSources, double *sumSqr);
+#endif
+
+// ---------------------
+// the kernel being used
+// ---------------------
+
+static DeficitKernel *kernel_=&scalarKernel;
+static const char    *kernelName_="scalar";
+
+// ================================================================================
+//
+// name:          selectDeficitKernel
+//
+// function:      chooses the kernel used by accumulateDeficits (one the processor
+//                can't run falls back to the best one it can)
+//
+// parameters:    kernel.......the kernel (DEFICIT_KERNEL_...)
+//
+// returns:       (int) the kernel chosen
+//
+// ================================================================================
+
+int selectDeficitKernel(int kernel)
+{
+  int best;
+
+  best = DEFICIT_KERNEL_SCALAR;
+
+#ifdef DEFICIT_KERNEL_X86
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx512f"))
+    best = DEFICIT_KERNEL_AVX512;
+  else
+    if (__builtin_cpu_supports("avx2"))
+      best = DEFICIT_KERNEL_AVX2;
+#endif
+
+  if ((kernel==DEFICIT_KERNEL_AUTO)||(kernel>best))
+    kernel = best;
+
+  switch (kernel)
+    {
+#ifdef DEFICIT_KERNEL_X86
+    case DEFICIT_KERNEL_AVX512:
+      kernel_     = &avx512Kernel;
+      kernelName_ = "AVX-512";
+      break;
+
+    case DEFICIT_KERNEL_AVX2:
+      kernel_     = &avx2Kernel;
+      kernelName_ = "AVX2";
+      break;
+#endif
+
+    default:
+      kernel      = DEFICIT_KERNEL_SCALAR;
+      kernel_     = &scalarKernel;
+      kernelName_ = "scalar";
+    }
+
+  // get back
+
+  return kernel;
+}
+
+// ================================================================================
+//
+// name:          getDeficitKernelName
+//
+// function:      returns the name of the kernel being used
+//
+// parameters:    (none)
+//
+// returns:       (const char*) the name
+//
+// ================================================================================
+
+const char *getDeficitKernelName()
+{
+  return kernelName_;
+}
+
+// ================================================================================
+//
+// name:          accumulateDeficits
+//
+// function:      adds the squared deficits caused by a number of sources to the sums
+//                of one receiving turbine, for all the speed bins at once; the
+//                deficit of source k in bin l is induction[l]*shrink[k]*overlap[k]
+//                (multiplied in this order, so that all the kernels give the very
+//                same sums)
+//
+// parameters:    induction....the axial induction of each bin
+//                numBins......the number of bins
+//                shrink.......the drop of each source's deficit with the distance
+//                overlap......the fraction of the receiver in each source's wake
+//                numSources...the number of sources
+//                sumSqr.......the sums of squared deficits of each bin (updated)
+//
+// returns:       (void)
+//
+// ================================================================================
+
+void accumulateDeficits(const double *induction, int numBins, const double *shrink, const double *overlap, int numSources, double *sumSqr)
+{
+  kernel_(induction,numBins,shrink,overlap,numSources,sumSqr);
+}
+
+// ================================================================================
+//
+// name:          scalarKernel
+//
+// function:      the kernel for any processor, one bin at a time
+//
+// parameters:    (see accumulateDeficits)
+//
+// returns:       (void)
+//
+// ================================================================================
+
+static void scalarKernel(const double *induction, int numBins, const double *shrink, const double *overlap, int numSources, double *sumSqr)
+{
+  int l,k;
+  double sum;
+  double deficit;
+
+  for (l=0; l<numBins; l++)
+    {
+      sum = sumSqr[l];
+
+      for (k=0; k<numSources; k++)
+	{
+	  deficit = induction[l]*shrink[k]*overlap[k];
+	  sum += deficit*deficit;
+	}
+
+      sumSqr[l] = sum;
+    }
+}
+
+#ifdef DEFICIT_KERNEL_X86
+
+// ================================================================================
+//
+// name:          avx2Kernel
+//
+// function:      the kernel doing 4 bins at once with AVX2 (no FMA, which would
+//                round differently from the scalar kernel)
+//
+// parameters:    (see accumulateDeficits)
+//
+// returns:       (void)
+//
+// ================================================================================
+
+__attribute__((target("avx2")))
+static void avx2Kernel(const double *induction, int numBins, const double *shrink, const double *overlap, int numSources, double *sumSqr)
+{
+  int l,k;
+  __m256d a,sum,deficit;
+
+  for (l=0; l+4<=numBins; l+=4)
+    {
+      a   = _mm256_loadu_pd(induction+l);
+      sum = _mm256_loadu_pd(sumSqr+l);
+
+      for (k=0; k<numSources; k++)
+	{
+	  deficit = _mm256_mul_pd(_mm256_mul_pd(a,_mm256_set1_pd(shrink[k])),_mm256_set1_pd(overlap[k]));
+	  sum     = _mm256_add_pd(sum,_mm256_mul_pd(deficit,deficit));
+	}
+
+      _mm256_storeu_pd(sumSqr+l,sum);
+    }
+
+  // the bins left
+
+  if (l<numBins)
+    scalarKernel(induction+l,numBins-l,shrink,overlap,numSources,sumSqr+l);
+}
+
+// ================================================================================
+//
+// name:          avx512Kernel
+//
+// function:      the kernel doing 8 bins at once with AVX-512 (compiled without
+//                contracting the products and sums into FMA, which would round
+//                differently from the scalar kernel)
+//
+// parameters:    (see accumulateDeficits)
+//
+// returns:       (void)
+//
+// ================================================================================
+
+__attribute__((target("avx512f"),optimize("fp-contract=off")))
+static void avx512Kernel(const double *induction, int numBins, const double *shrink, const double *overlap, int numSources, double *sumSqr)
+{
+  int l,k;
+  __m512d a,sum,deficit;
+
+  for (l=0; l+8<=numBins; l+=8)
+    {
+      a   = _mm512_loadu_pd(induction+l);
+      sum = _mm512_loadu_pd(sumSqr+l);
+
+      for (k=0; k<numSources; k++)
+	{
+	  deficit = _mm512_mul_pd(_mm512_mul_pd(a,_mm512_set1_pd(shrink[k])),_mm512_set1_pd(overlap[k]));
+	  sum     = _mm512_add_pd(sum,_mm512_mul_pd(deficit,deficit));
+	}
+
+      _mm512_storeu_pd(sumSqr+l,sum);
+    }
+
+  // the bins left
+
+  if (l<numBins)
+    avx2Kernel(induction+l,numBins-l,shrink,overlap,numSources,sumSqr+l);
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef _deficitKernel_h_
+#define _deficitKernel_h_
+
+#define DEFICIT_KERNEL_AUTO   0  // the best one the processor can run
+#define DEFICIT_KERNEL_SCALAR 1
+#define DEFICIT_KERNEL_AVX2   2  // 4 speed bins at once
+#define DEFICIT_KERNEL_AVX512 3  // 8 speed bins at once
+
+// adds (induction[l]*shrink[k]*overlap[k])^2 over the sources k=0..numSources-1
+// to sumSqr[l] for all the speed bins l=0..numBins-1 of one receiving turbine
+
+typedef void DeficitKernel(const double *induction, int numBins, const double *shrink, const double *overlap, int numSources, double *sumSqr);
+
+int  selectDeficitKernel(int kernel);
+const char *getDeficitKernelName();
+
+void accumulateDeficits(const double *induction, int numBins, const double *shrink, const double *overlap, int numSources, double *sumSqr);
+
+#endif
@@ -64,9 +64,22 @@
 #include "fitness.h"
 #include "boa.h"
 #include "WindFarmLayout.h"
+#include "WakeInteractionTable.h"
+#include "deficitKernel.h"
+#include "fitnessCache.h"
 
 #define numFitness 7
 
+// ----------------------------------------------------------
+// the siting grid of the wind farm layout (bit i of a string
+// is the site ((i/WFLO_GRID_COLUMNS)*WFLO_GRID_SPACING,
+// (i%WFLO_GRID_COLUMNS)*WFLO_GRID_SPACING))
+// ----------------------------------------------------------
+
+#define WFLO_GRID_COLUMNS 10
+#define WFLO_GRID_SPACING 300
+#define WFLO_NUM_TURBINES 30
+
 static Fitness fitnessDesc[numFitness] = {
   {"ONEMAX",&onemax,&areAllGenesOne,NULL,NULL},
   {"Quadratic 0.9 0 0 1",&quadratic,&areAllGenesOne,NULL,NULL},
@@ -74,7 +87,7 @@ static Fitness fitnessDesc[numFitness] = {
   {"5-ORDER TRAP (Illinois Report No. 95008)",&trap5,&areAllGenesOne,NULL,NULL},
   {"3deceptive Bipolar",&f3deceptiveBipolar,&areBlocks6ZeroOrOne,NULL,NULL},
   {"3deceptive (OVERLAPPING in 1bit)",&f3deceptiveOverlapping,&areAllGenesOne,NULL,NULL},
-  {"Wind Farm Layout",&wflofitness,NULL,NULL,NULL},
+  {"Wind Farm Layout",&wflofitness,NULL,&initWfloFitness,&doneWfloFitness},
 };
 
 // ------------------
@@ -83,11 +96,13 @@ static Fitness fitnessDesc[numFitness] = {
 
 Fitness *fitness;
 
-// ---------------------------
-// the number of fitness calls
-// ---------------------------
+// ------------------------------------------------------------------
+// the number of fitness calls (requested, and really computed - those
+// not found in the fitness cache)
+// ------------------------------------------------------------------
 
 long   fitnessCalls_;
+long   fitnessComputations_;
 
 
 std::string wl_file = "input/init_layout.out";
@@ -106,6 +121,12 @@ std::string fpowerTable = "input/powerTable";
 WindFarmLayout wind_farm_layout (wl_file.c_str(), turbine_file.c_str(), wrf_file.c_str(), fcoordinates,
 																			fwindDirections, fwindSpeeds, fwindProb, fZ,
 																			fCt, fDRot, fZ0, fpowerTable);
+
+// ------------------------------------------------------------
+// the precomputed wake interactions on the siting grid (if any)
+// ------------------------------------------------------------
+
+WakeInteractionTable *wakeTable=NULL;
 // ================================================================================
 //
 // name:          onemax
@@ -362,7 +383,8 @@ float wflofitness (char *x, int n)
 																			fwindDirections, fwindSpeeds, fwindProb, fZ,
 																			fCt, fDRot, fZ0, fpowerTable);*/
 
-	int turs = 30;	
+	int turs = WFLO_NUM_TURBINES;	
+	FarmPowerResult result; // local, so that layouts can be evaluated in parallel
 	int count = 0;
 	for (int i=0; i<n;i++){
 		if (x[i] == 1){
@@ -375,6 +397,20 @@ float wflofitness (char *x, int n)
 		return (-1*((count-turs)*(count-turs)));
 	}
 
+	// with the interaction table, the sites are all we need
+
+	if (wakeTable)
+	{
+		int sites[WFLO_NUM_TURBINES];
+
+		count = 0;
+		for (int i=0; (i<n)&&(count<turs); i++)
+			if (x[i] == 1)
+				sites[count++] = i;
+
+		return (float)(wakeTable->evaluateLayout(sites,turs,&result));
+	}
+
 	arma::vec turbines (turs*2);
 	
 	count = 0;
@@ -383,38 +419,144 @@ float wflofitness (char *x, int n)
 			int j = i;
 			int x,y;
 			
-			if (i<10){
+			if (i<WFLO_GRID_COLUMNS){
 				x = 0;
 				y = i;
 			}
 			else {
-				y = i%10;
-				x = (i-y)/10;
+				y = i%WFLO_GRID_COLUMNS;
+				x = (i-y)/WFLO_GRID_COLUMNS;
 			}
 			if (count < turs){
-			turbines(count) = (x*300);
+			turbines(count) = (x*WFLO_GRID_SPACING);
 			int test = count + turs;
-			turbines (test) = (y*300);
+			turbines (test) = (y*WFLO_GRID_SPACING);
 		}
 			count = count + 1;
 		}
 	}
 
 	//std::cout <<turbines <<std::endl;
-	f = (float)(wind_farm_layout.calculateFarmPower(turbines));
-	
-	if (f > 100){
-		for (int i=0;i<10;i++){
-			for (int j=0;j<10;j++){
-				std::cout <<(int)(x[(10*i)+j])<<" ";
-			}		
-					std::cout <<std::endl;
-		}
-					std::cout <<std::endl;
-	}	
+	f = (float)(wind_farm_layout.evaluateLayout(turbines,&result));
+
 	return f;
 }
 
+// ================================================================================
+//
+// name:          initWfloFitness
+//
+// function:      chooses the kernel summing the wake deficits, sets the
+//                rotor-wake overlap, compresses the wind rose (if requested) and
+//                builds the table of wake interactions between all sites of the
+//                siting grid (if requested and if the wake model allows it)
+//
+// parameters:    boaParams....the parameters passed to the BOA
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int initWfloFitness(BoaParams *boaParams)
+{
+  int i;
+  int uniform;
+
+  wakeTable = NULL;
+
+  // the kernel summing the deficits of the speed bins
+
+  selectDeficitKernel(boaParams->deficitKernel);
+  printf("Deficit kernel: %s\n",getDeficitKernelName());
+
+  // how much of a rotor is in a wake
+
+  if ((boaParams->wakeOverlapMode<WAKE_OVERLAP_SAMPLED)||(boaParams->wakeOverlapMode>WAKE_OVERLAP_AREA))
+    {
+      fprintf(stderr,"ERROR: Specified wake overlap mode doesn't exist (%i)!\n",boaParams->wakeOverlapMode);
+      exit(-1);
+    }
+
+  wind_farm_layout.setOverlapMode(boaParams->wakeOverlapMode);
+
+  // leave out the bins of the wind rose that hardly matter
+
+  if (boaParams->windRoseMaxError>0)
+    {
+      unsigned numBins=0;
+
+      for (i=0; i<(int) wind_farm_layout.windDirections.n_elem; i++)
+	numBins += wind_farm_layout.binsPerDirection[i];
+
+      wind_farm_layout.compressWindRose(boaParams->windRoseMaxError);
+
+      printf("Wind rose: %u bins -> ",numBins);
+
+      numBins = 0;
+      for (i=0; i<(int) wind_farm_layout.windDirections.n_elem; i++)
+	numBins += wind_farm_layout.binsPerDirection[i];
+
+      printf("%u bins (efficiency error bound %g)\n",numBins,wind_farm_layout.windRoseErrorBound);
+    }
+
+  if (boaParams->wakeTableMode==0)
+    return 0;
+
+#ifdef CT_DEPENDENT
+  fprintf(stderr,"WARNING: Wake interaction table not available with a Ct-dependent wake radius, not used.\n");
+  return 0;
+#endif
+
+  // the table assumes the same kind of turbine everywhere
+
+  uniform = 1;
+  for (i=1; i<wind_farm_layout.numT; i++)
+    if ((wind_farm_layout.DRot(i)!=wind_farm_layout.DRot(0))||
+	(wind_farm_layout.Z(i)!=wind_farm_layout.Z(0))||
+	(wind_farm_layout.Z0(i)!=wind_farm_layout.Z0(0)))
+      uniform = 0;
+
+  if (!uniform)
+    {
+      fprintf(stderr,"WARNING: Wake interaction table requires identical turbines, not used.\n");
+      return 0;
+    }
+
+  wakeTable = new WakeInteractionTable(&wind_farm_layout,
+				       boaParams->n,
+				       WFLO_GRID_COLUMNS,
+				       WFLO_GRID_SPACING,
+				       (boaParams->wakeTableMode==1)? TABLE_MODE_SITES:TABLE_MODE_OFFSET);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          doneWfloFitness
+//
+// function:      frees the table of wake interactions (if any)
+//
+// parameters:    boaParams....the parameters passed to the BOA
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int doneWfloFitness(BoaParams *boaParams)
+{
+  if (wakeTable)
+    delete wakeTable;
+
+  wakeTable = NULL;
+
+  // get back
+
+  return 0;
+}
+
 //char areAllTurbinesOptimal(char *x, int n){
 //}
 
@@ -573,7 +715,8 @@ int doneFitness(BoaParams *boaParams)
 //
 // name:          getFitnessValue
 //
-// function:      evaluates the fitness for an input string
+// function:      evaluates the fitness for an input string (takes it from the
+//                fitness cache if the string has been evaluated recently)
 //
 // parameters:    x............the string
 //                n............the length of the string
@@ -584,8 +727,23 @@ int doneFitness(BoaParams *boaParams)
 
 float getFitnessValue(char *x, int n) 
 {
+  float f;
+
   fitnessCalled();
-  return fitness->fitness(x,n);
+
+  // evaluated recently?
+
+  if (lookupFitnessCache(x,n,&f))
+    return f;
+
+  // no, compute it and remember it
+
+  fitnessComputed();
+  f = fitness->fitness(x,n);
+
+  insertFitnessCache(x,n,f);
+
+  return f;
 }
 
 // ================================================================================
@@ -639,6 +797,8 @@ int isOptimal(char *x, int n)
 
 int resetFitnessCalls(void)
 {
+  fitnessComputations_=0;
+
   return (int) (fitnessCalls_=0);
 }
 
@@ -646,7 +806,9 @@ int resetFitnessCalls(void)
 
 long fitnessCalled(void)
 {
-  return fitnessCalls_++;
+  // atomic, the fitness may be called from several threads at once
+
+  return __sync_fetch_and_add(&fitnessCalls_,1);
 }
 
 // =============================================================
@@ -655,3 +817,19 @@ long getFitnessCalls(void)
 {
   return fitnessCalls_;
 }
+
+// =============================================================
+
+long fitnessComputed(void)
+{
+  // atomic, the fitness may be computed in several threads at once
+
+  return __sync_fetch_and_add(&fitnessComputations_,1);
+}
+
+// =============================================================
+
+long getFitnessComputations(void)
+{
+  return fitnessComputations_;
+}
@@ -25,6 +25,9 @@ float f3deceptiveBipolar(char *x, int n);
 float f3deceptiveOverlapping(char *x, int n);
 float wflofitness(char *x, int n);
 
+int initWfloFitness(BoaParams *boaParams);
+int doneWfloFitness(BoaParams *boaParams);
+
 char areAllGenesOne(char *x, int n);
 char areBlocks6ZeroOrOne(char *x, int n);
 
@@ -40,5 +43,7 @@ int isOptimal(char *x, int n);
 int resetFitnessCalls(void);
 long fitnessCalled(void);
 long getFitnessCalls(void);
+long fitnessComputed(void);
+long getFitnessComputations(void);
 
 #endif
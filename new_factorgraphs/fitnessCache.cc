@@ -0,0 +1,440 @@
+// ################################################################################
+//
+// name:          fitnessCache.cc
+//
+// purpose:       a bounded cache of fitness values keyed by the (packed) string,
+//                so that duplicate strings are not evaluated again; entries are
+//                found by a 64-bit hash of the string, verified on the whole
+//                string, and evicted by the CLOCK (second chance) policy
+//
+// ################################################################################
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "fitnessCache.h"
+#include "memalloc.h"
+
+// -------------------------------------------------------------------
+// the packed strings of up to this many bytes are packed on the stack
+// -------------------------------------------------------------------
+
+#define MAX_STACK_KEY 1024
+
+// --------------------
+// an entry of the cache
+// --------------------
+
+typedef struct {
+  uint64_t hash;        // hash of the packed string
+  float    f;           // its fitness
+  char     referenced;  // hit since the clock hand last passed?
+  long     next;        // next entry in the same bucket (-1 if none)
+} CacheEntry;
+
+// ---------
+// the cache
+// ---------
+
+static long            capacity=0;   // maximal number of entries (0 = no cache)
+static long            used;         // number of entries used
+static long            hand;         // the clock hand
+static int             keyBytes;     // the length of a packed string
+static CacheEntry      *entry=NULL;
+static unsigned char   *keys=NULL;   // packed strings of all entries
+static long            *bucket=NULL; // first entry of each bucket (-1 if none)
+static uint64_t        bucketMask;
+
+static pthread_mutex_t cacheLock;
+
+static long            hits;
+static long            misses;
+
+static int      packString(char *x, int n, unsigned char *key);
+static uint64_t hashKey(unsigned char *key);
+static long     findEntry(uint64_t hash, unsigned char *key);
+static long     evictEntry();
+
+// ================================================================================
+//
+// name:          initializeFitnessCache
+//
+// function:      allocates the cache
+//
+// parameters:    size.........the maximal number of cached strings (0 or less
+//                             turns the cache off)
+//                n............the length of the strings
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int initializeFitnessCache(long size, int n)
+{
+  long i;
+  long numBuckets;
+
+  hits = misses = 0;
+  used = hand   = 0;
+
+  if (size<=0)
+    {
+      capacity = 0;
+      return 0;
+    }
+
+  capacity = size;
+  keyBytes = (n+7)/8;
+
+  // allocate the entries and their strings
+
+  entry = (CacheEntry*) Calloc(capacity,sizeof(CacheEntry));
+  keys  = (unsigned char*) Calloc(capacity,keyBytes);
+
+  // allocate the buckets (a power of two, at least as many as entries)
+
+  for (numBuckets=1; numBuckets<capacity; numBuckets<<=1);
+
+  bucket     = (long*) Calloc(numBuckets,sizeof(long));
+  bucketMask = numBuckets-1;
+
+  for (i=0; i<numBuckets; i++)
+    bucket[i] = -1;
+
+  pthread_mutex_init(&cacheLock,NULL);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          doneFitnessCache
+//
+// function:      frees the cache
+//
+// parameters:    (none)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int doneFitnessCache()
+{
+  if (capacity==0)
+    return 0;
+
+  Free(entry);
+  Free(keys);
+  Free(bucket);
+
+  entry    = NULL;
+  keys     = NULL;
+  bucket   = NULL;
+  capacity = 0;
+
+  pthread_mutex_destroy(&cacheLock);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          lookupFitnessCache
+//
+// function:      looks up the fitness of a string in the cache
+//
+// parameters:    x............the string
+//                n............the length of the string
+//                f............where to put its fitness (if found)
+//
+// returns:       (int) 1 if found, 0 otherwise
+//
+// ================================================================================
+
+int lookupFitnessCache(char *x, int n, float *f)
+{
+  unsigned char stackKey[MAX_STACK_KEY];
+  unsigned char *key;
+  uint64_t hash;
+  long i;
+
+  if (capacity==0)
+    return 0;
+
+  // pack the string and hash it
+
+  key = (keyBytes<=MAX_STACK_KEY)? stackKey:(unsigned char*) Malloc(keyBytes);
+
+  packString(x,n,key);
+  hash = hashKey(key);
+
+  // find it
+
+  pthread_mutex_lock(&cacheLock);
+
+  i = findEntry(hash,key);
+
+  if (i>=0)
+    {
+      *f = entry[i].f;
+      entry[i].referenced = 1;
+      hits++;
+    }
+  else
+    misses++;
+
+  pthread_mutex_unlock(&cacheLock);
+
+  if (key!=stackKey)
+    Free(key);
+
+  // get back
+
+  return (i>=0);
+}
+
+// ================================================================================
+//
+// name:          insertFitnessCache
+//
+// function:      inserts the fitness of a string into the cache (evicts an old
+//                entry if the cache is full)
+//
+// parameters:    x............the string
+//                n............the length of the string
+//                f............its fitness
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int insertFitnessCache(char *x, int n, float f)
+{
+  unsigned char stackKey[MAX_STACK_KEY];
+  unsigned char *key;
+  uint64_t hash;
+  long i;
+  long b;
+
+  if (capacity==0)
+    return 0;
+
+  // pack the string and hash it
+
+  key = (keyBytes<=MAX_STACK_KEY)? stackKey:(unsigned char*) Malloc(keyBytes);
+
+  packString(x,n,key);
+  hash = hashKey(key);
+
+  pthread_mutex_lock(&cacheLock);
+
+  // someone else might have put it in meanwhile
+
+  if (findEntry(hash,key)<0)
+    {
+      // get a free entry
+
+      if (used<capacity)
+	i = used++;
+      else
+	i = evictEntry();
+
+      // fill it in and put it at the head of its bucket
+
+      b = hash&bucketMask;
+
+      entry[i].hash       = hash;
+      entry[i].f          = f;
+      entry[i].referenced = 0;
+      entry[i].next       = bucket[b];
+      memcpy(keys+i*keyBytes,key,keyBytes);
+
+      bucket[b] = i;
+    }
+
+  pthread_mutex_unlock(&cacheLock);
+
+  if (key!=stackKey)
+    Free(key);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          isFitnessCacheOn
+//
+// function:      returns whether the cache is in use
+//
+// parameters:    (none)
+//
+// returns:       (int) non-zero if the cache is used, 0 otherwise
+//
+// ================================================================================
+
+int isFitnessCacheOn()
+{
+  return (capacity>0);
+}
+
+// ================================================================================
+//
+// name:          getFitnessCacheHits
+//
+// function:      returns the number of lookups that found the string
+//
+// parameters:    (none)
+//
+// returns:       (long) the number of hits
+//
+// ================================================================================
+
+long getFitnessCacheHits()
+{
+  return hits;
+}
+
+// ================================================================================
+//
+// name:          getFitnessCacheMisses
+//
+// function:      returns the number of lookups that did not find the string
+//
+// parameters:    (none)
+//
+// returns:       (long) the number of misses
+//
+// ================================================================================
+
+long getFitnessCacheMisses()
+{
+  return misses;
+}
+
+// ================================================================================
+//
+// name:          packString
+//
+// function:      packs a binary string into bits (8 per byte)
+//
+// parameters:    x............the string
+//                n............the length of the string
+//                key..........the packed string (output)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int packString(char *x, int n, unsigned char *key)
+{
+  int k;
+
+  memset(key,0,keyBytes);
+
+  for (k=0; k<n; k++)
+    if (x[k])
+      key[k>>3] |= (unsigned char) (1<<(k&7));
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          hashKey
+//
+// function:      computes a 64-bit hash of a packed string (FNV-1a)
+//
+// parameters:    key..........the packed string
+//
+// returns:       (uint64_t) the hash
+//
+// ================================================================================
+
+static uint64_t hashKey(unsigned char *key)
+{
+  int k;
+  uint64_t hash;
+
+  hash = 14695981039346656037ULL;
+
+  for (k=0; k<keyBytes; k++)
+    {
+      hash ^= key[k];
+      hash *= 1099511628211ULL;
+    }
+
+  return hash;
+}
+
+// ================================================================================
+//
+// name:          findEntry
+//
+// function:      finds the entry of a packed string (the lock must be held)
+//
+// parameters:    hash.........the hash of the packed string
+//                key..........the packed string
+//
+// returns:       (long) the entry or -1 if there is none
+//
+// ================================================================================
+
+static long findEntry(uint64_t hash, unsigned char *key)
+{
+  long i;
+
+  for (i=bucket[hash&bucketMask]; i>=0; i=entry[i].next)
+    if ((entry[i].hash==hash)&&(!memcmp(keys+i*keyBytes,key,keyBytes)))
+      return i;
+
+  return -1;
+}
+
+// ================================================================================
+//
+// name:          evictEntry
+//
+// function:      moves the clock hand to the first entry not hit since the hand
+//                last passed it and removes that entry from its bucket (the lock
+//                must be held)
+//
+// parameters:    (none)
+//
+// returns:       (long) the evicted entry
+//
+// ================================================================================
+
+static long evictEntry()
+{
+  long i;
+  long *link;
+
+  // give a second chance to those that were hit
+
+  while (entry[hand].referenced)
+    {
+      entry[hand].referenced = 0;
+      hand = (hand+1)%capacity;
+    }
+
+  i    = hand;
+  hand = (hand+1)%capacity;
+
+  // unlink it from its bucket
+
+  for (link=&(bucket[entry[i].hash&bucketMask]); *link!=i; link=&(entry[*link].next));
+
+  *link = entry[i].next;
+
+  // get back
+
+  return i;
+}
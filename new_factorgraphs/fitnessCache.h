@@ -0,0 +1,14 @@
+#ifndef _fitnessCache_h_
+#define _fitnessCache_h_
+
+int initializeFitnessCache(long size, int n);
+int doneFitnessCache();
+
+int lookupFitnessCache(char *x, int n, float *f);
+int insertFitnessCache(char *x, int n, float f);
+
+int  isFitnessCacheOn();
+long getFitnessCacheHits();
+long getFitnessCacheMisses();
+
+#endif
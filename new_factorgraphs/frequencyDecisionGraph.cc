@@ -18,6 +18,21 @@
 
 #include "decisionGraph.h"
 #include "frequencyDecisionGraph.h"
+#include "memalloc.h"
+#include "bitCount.h"
+
+// ------------------------------------------------------------------------
+// the split frequencies of a node are computed from the bit columns of the
+// population when it has at least this many instances per 64-bit word
+// ------------------------------------------------------------------------
+
+#define BIT_COUNT_MIN_INSTANCES_PER_WORD 1
+
+// ------------------------------------------------------------------------
+// the bitsets of a node with up to this many words are kept on the stack
+// ------------------------------------------------------------------------
+
+#define MAX_STACK_WORDS 256
 
 #define SHIFT_STEP 4
 
@@ -29,12 +44,13 @@
 //
 // parameters:    p....population to bind  this frequency graph to (we must have
 //                     the data set in advance, it's just better i guess)
+//                arena....the arena to allocate the graph in (NULL = the heap)
 //
 // returns:       void
 //
 // ================================================================================
 
-FrequencyDecisionGraph::FrequencyDecisionGraph(Population *p):DecisionGraph()
+FrequencyDecisionGraph::FrequencyDecisionGraph(Population *p, Arena *arena):DecisionGraph(arena)
 {
   // set the active population and disable the position of an active bit
 
@@ -43,7 +59,8 @@ FrequencyDecisionGraph::FrequencyDecisionGraph(Population *p):DecisionGraph()
 
   // allocate the instance index stuff (we don't do this in traditional decision trees)
 
-  getRoot()->allocateInstanceIndexEntries(p->n);
+  getRoot()->parentLabels = (uint64_t*) allocateMemory(((p->n+63)/64)*sizeof(uint64_t));
+  setAllInstances(getRoot());
 
   // the probability in the root is 1 (no position associated with the tree)
 
@@ -60,12 +77,13 @@ FrequencyDecisionGraph::FrequencyDecisionGraph(Population *p):DecisionGraph()
 //                myPosition...the position (variable) we want to bind this graph 
 //                             with (we can do this and will use this mostly in 
 //                             fact)
+//                arena........the arena to allocate the graph in (NULL = the heap)
 //
 // returns:       void
 //
 // ================================================================================
 
-FrequencyDecisionGraph::FrequencyDecisionGraph(Population *p, int myPosition):DecisionGraph()
+FrequencyDecisionGraph::FrequencyDecisionGraph(Population *p, int myPosition, Arena *arena):DecisionGraph(arena)
 {
   double f;
 
@@ -76,7 +94,8 @@ FrequencyDecisionGraph::FrequencyDecisionGraph(Population *p, int myPosition):De
 
   // allocate the instance index stuff (we don't do this in traditional decision trees)
 
-  getRoot()->allocateInstanceIndexEntries(p->n);
+  getRoot()->parentLabels = (uint64_t*) allocateMemory(((p->n+63)/64)*sizeof(uint64_t));
+  setAllInstances(getRoot());
 
   // the probability in the root is the univariate frequency in the position
 
@@ -102,6 +121,27 @@ FrequencyDecisionGraph::FrequencyDecisionGraph(Population *p, int myPosition):De
 
 int FrequencyDecisionGraph::merge(LabeledTreeNode *x, LabeledTreeNode *y)
 {
+  long *instance;
+
+  // the instances of both go to x
+
+  instance = (long*) allocateMemory((x->numInstances+y->numInstances)*sizeof(long));
+  memcpy(instance,x->instance,x->numInstances*sizeof(long));
+  memcpy(instance+x->numInstances,y->instance,y->numInstances*sizeof(long));
+
+  if (x->ownsInstances)
+    freeMemory(x->instance);
+  if (y->ownsInstances)
+    freeMemory(y->instance);
+
+  x->instance      = instance;
+  x->numInstances += y->numInstances;
+  x->ownsInstances = 1;
+
+  y->instance      = NULL;
+  y->numInstances  = 0;
+  y->ownsInstances = 0;
+
   // increase the value in x by the value in y
 
   x->value[0] += y->value[0];
@@ -122,8 +162,8 @@ int FrequencyDecisionGraph::merge(LabeledTreeNode *x, LabeledTreeNode *y)
 // name:          FrequencyDecisionGraph::split
 //
 // function:      splits the node on a particular value (label)
-//                (usually identifying a variable)
-//                NOTE: WE DO NOT RECOMPUTE THE FREQUENCIES HERE!!
+//                (usually identifying a variable); the frequencies of the two
+//                new leaves are counted on the instances that get to them
 //
 // parameters:    x.......a pointer to the node
 //                label...which label (variable id or feature) to split on
@@ -134,40 +174,104 @@ int FrequencyDecisionGraph::merge(LabeledTreeNode *x, LabeledTreeNode *y)
 
 int FrequencyDecisionGraph::split(LabeledTreeNode *x, int label)
 {
+  long i,j;
+  long tmp;
+  int  numWords;
+  LabeledTreeNode *child;
+  int  c;
+
   // split the node x now
 
   DecisionGraph::split(x,label);
 
-  // allocate instance/frequency related stuff for both children
+  // partition the instances of x, those with 0 on the label go first (to the left
+  // child), the children then just point to their part
 
-  x->left->allocateInstanceIndexEntries(p->n);
-  x->right->allocateInstanceIndexEntries(p->n);
- 
-  // it is sufficient to compute frequencies for one of the two new instances,
-  // because the second one can be computed by using the value in x (which is
-  // the sum of the two), so that's what we're gonna do
+  i = 0;
+  j = x->numInstances-1;
 
-  // copy the instance information from the parent to the new children (if any)
-  
-  if (x->depth>0)
+  while (i<=j)
+    if (p->x[x->instance[i]][label]==0)
+      i++;
+    else
+      {
+	tmp            = x->instance[i];
+	x->instance[i] = x->instance[j];
+	x->instance[j] = tmp;
+	j--;
+      }
+
+  x->left->instance      = x->instance;
+  x->left->numInstances  = i;
+  x->right->instance     = x->instance+i;
+  x->right->numInstances = x->numInstances-i;
+
+  // the children have got the labels of x and the new one above them
+
+  numWords = (p->n+63)/64;
+
+  for (c=0; c<2; c++)
     {
-      memcpy(x->left->parentLabelCoincidenceVector,x->parentLabelCoincidenceVector,p->n);
-      memcpy(x->right->parentLabelCoincidenceVector,x->parentLabelCoincidenceVector,p->n);
-    };
-  
-  // add the new information to each child
-  
-  x->left->parentLabelCoincidenceVector[x->label]  = 1;
-  x->right->parentLabelCoincidenceVector[x->label] = 1;
-  
-  // should recompute frequencies?!!! (well i take care of this elsewhere
-  // its faster - but careful about this....
-  
+      child = (c==0)? x->left:x->right;
+
+      child->parentLabels = (uint64_t*) allocateMemory(numWords*sizeof(uint64_t));
+      memcpy(child->parentLabels,x->parentLabels,numWords*sizeof(uint64_t));
+      child->parentLabels[label>>6] |= ((uint64_t) 1)<<(label&63);
+
+      // count the frequencies in the child
+
+      child->value[0] = child->value[1] = 0;
+
+      if (myPosition>=0)
+	for (i=0; i<child->numInstances; i++)
+	  child->value[(int) p->x[child->instance[i]][myPosition]] += p->weight[child->instance[i]];
+      else
+	for (i=0; i<child->numInstances; i++)
+	  child->value[0] += p->weight[child->instance[i]];
+
+      child->value[0] /= (double)p->N;
+      if (myPosition>=0)
+	child->value[1] /= (double)p->N;
+    }
+
   // get back
   
   return 0;
 }
 
+// ================================================================================
+//
+// name:          FrequencyDecisionGraph::setAllInstances
+//
+// function:      makes all the instances of the population get to a node (the
+//                root before any split); the copies of a string are one instance
+//                with the weight of the string
+//
+// parameters:    x.......a pointer to the node
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int FrequencyDecisionGraph::setAllInstances(LabeledTreeNode *x)
+{
+  long i;
+
+  if (x->ownsInstances)
+    freeMemory(x->instance);
+
+  x->instance      = (long*) allocateMemory(p->numUnique*sizeof(long));
+  x->numInstances  = p->numUnique;
+  x->ownsInstances = 1;
+
+  for (i=0; i<p->numUnique; i++)
+    x->instance[i] = i;
+
+  // get back
+
+  return 0;
+}
+
 // ================================================================================
 //
 // name:          FrequencyDecisionGraph::univariateFrequency
@@ -194,8 +298,9 @@ double FrequencyDecisionGraph::univariateFrequency(int k)
   // compute the frequency of x_k=1
 
   count=0;
-  for (i=0; i<N; i++)
-    count += p->x[i][k];
+  for (i=0; i<p->numUnique; i++)
+    if (p->x[i][k])
+      count += p->weight[i];
 
   // return the resulting frequency
 
@@ -206,9 +311,9 @@ double FrequencyDecisionGraph::univariateFrequency(int k)
 //
 // name:          FrequencyDecisionGraph::computeFrequencies
 //
-// function:      compute all frequencies encoded by the tree, it's just as fast
-//                as if we wanted to recompute the stuff for just one leaf, as it
-//                is implemented. we pay for being a graph not a tree here...
+// function:      compute all frequencies encoded by the tree (each leaf knows
+//                the instances that get to it, so nothing has to be routed from
+//                the root)
 //
 // parameters:    (none)
 //
@@ -223,7 +328,6 @@ int FrequencyDecisionGraph::computeFrequencies()
   int numLeaves;
   long N;
   LabeledTreeNode *node;
-  char *s;
   NodeListItem *leafItem;
 
   // set helper variables
@@ -231,32 +335,21 @@ int FrequencyDecisionGraph::computeFrequencies()
   N         = p->N;
   numLeaves = getNumLeaves();
 
-  // set the value in all leaves to 0
+  // count the instances in each leaf
 
   leafItem = getLeaves();
   for (j=0; j<numLeaves; j++, leafItem=leafItem->next)
-    leafItem->x->value[0]=leafItem->x->value[1]=0;
-  
-  // compute the new values
-
-  for(i=0; i<N; i++)
     {
-      s=p->x[i];
-      node = getRoot();
-
-      while (node->which!=LEAF)
-	{
-	  if (s[node->label]==0)
-	    node = node->left;
-	  else
-	    node = node->right;
-	};
+      node = leafItem->x;
+      node->value[0] = node->value[1] = 0;
 
       if (myPosition>=0)
-	node->value[s[myPosition]]++;
+	for (i=0; i<node->numInstances; i++)
+	  node->value[(int) p->x[node->instance[i]][myPosition]] += p->weight[node->instance[i]];
       else
-	node->value[0]++;
-    };
+	for (i=0; i<node->numInstances; i++)
+	  node->value[0] += p->weight[node->instance[i]];
+    }
 
   // divide the values in all leaves by N
 
@@ -282,96 +375,95 @@ int FrequencyDecisionGraph::computeFrequencies()
 // name:          FrequencyDecisionGraph::computeSplitFrequencies
 //
 // function:      compute the frequencies we would get in the children of a given
-//                node if we performed splits on all possible labels (features)
-//
-// parameters:    x....the active node
-//                left0...value[0]'s for all left children, indexed by the split 
-//                        label
-//                left1...value[1]'s for all left children, indexed by the split 
-//                        label
-//                right0..value[0]'s for all left children, indexed by the split 
-//                        label
-//                right1..value[1]'s for all left children, indexed by the split 
-//                        label
+//                node if we performed the given splits on it
+//
+// parameters:    x...............the active node
+//                candidate.......the splits (only their labels are used)
+//                numCandidates...the number of the splits
+//                left0...value[0]'s for all left children, indexed by the split
+//                left1...value[1]'s for all left children, indexed by the split
+//                right0..value[0]'s for all right children, indexed by the split
+//                right1..value[1]'s for all right children, indexed by the split
 //                
 // returns:       (int) 0
 //
 // ================================================================================
 
-int FrequencyDecisionGraph::computeSplitFrequencies(LabeledTreeNode *x, double *left0, double *left1, double *right0, double *right1)
+int FrequencyDecisionGraph::computeSplitFrequencies(LabeledTreeNode *x, SplitCandidate *candidate, int numCandidates, double *left0, double *left1, double *right0, double *right1)
 {
   long i;
-  int  n;
   long N;
-  LabeledTreeNode *node;
   char *s;
-  int label;
+  long w;
+  long bitWords;
+  int c;
 
   // set helper variables
 
-  N         = p->N;
-  n         = p->n;
+  N = p->N;
 
   // reset the counts
 
-  for (label=0; label<n; label++)
-    left0[label] = left1[label] = right0[label] = right1[label] = 0;
+  for (c=0; c<numCandidates; c++)
+    left0[c] = left1[c] = right0[c] = right1[c] = 0;
 
-  // compute the frequencies
+  // compute the frequencies (only the instances in x matter, each with its
+  // weight), by counting bits when there are enough of them for the columns
+  // to pay off (the columns are gone through once for each bit of the weights)
 
-  for(i=0; i<N; i++)
-    {
-      s=p->x[i];
-      node = getRoot();
+  if (p->numWeightBits>0)
+    for (bitWords=0, i=0; i<p->numWeightBits; i++)
+      bitWords += p->weightWords[i];
+  else
+    bitWords = p->numWords;
 
-      while (node->which!=LEAF)
-	{
-	  if (s[node->label]==0)
-	    node = node->left;
-	  else
-	    node = node->right;
-	};
+  if (x->numInstances>=BIT_COUNT_MIN_INSTANCES_PER_WORD*bitWords)
+    countSplitFrequencies(x,candidate,numCandidates,left0,left1,right0,right1);
+  else
+    for(i=0; i<x->numInstances; i++)
+      {
+	s=p->x[x->instance[i]];
+	w=p->weight[x->instance[i]];
 
-      if (node==x)
 	if (myPosition>=0)
 	  {
-	    for (label=0; label<n; label++)
-	      if (s[label]==0)
+	    for (c=0; c<numCandidates; c++)
+	      if (s[candidate[c].label]==0)
 		if (s[myPosition])
-		  left1[label]++;
+		  left1[c] += w;
 		else
-		  left0[label]++;
+		  left0[c] += w;
 	      else
 		if (s[myPosition])
-		  right1[label]++;
+		  right1[c] += w;
 		else
-		  right0[label]++;
+		  right0[c] += w;
 	  }
 	else
 	  {
-	    for (label=0; label<n; label++)
-	      if (s[label]==0)
-		left0[label]++;
+	    for (c=0; c<numCandidates; c++)
+	      if (s[candidate[c].label]==0)
+		left0[c] += w;
 	      else
-		right0[label]++;
+		right0[c] += w;
 	  };
-    };
+      };
 
   // divide the values in all leaves by N
 
   if (myPosition>=0)
-    for (label=0; label<n; label++)
+    for (c=0; c<numCandidates; c++)
       {
-	left0[label]  /= (double)N;
-	left1[label]  /= (double)N;
-	right0[label] /= (double)N;
-	right1[label] /= (double)N;
+	left0[c]  /= (double)N;
+	left1[c]  /= (double)N;
+	right0[c] /= (double)N;
+	right1[c] /= (double)N;
       }
   else
-    for (label=0; label<n; label++)
+    for (c=0; c<numCandidates; c++)
       {
-	left0[label]  /= (double)N;
-	right0[label] /= (double)N;
+	left0[c]  /= (double)N;
+	right0[c] /= (double)N;
       };
 
   // get back
@@ -379,6 +471,149 @@ int FrequencyDecisionGraph::computeSplitFrequencies(LabeledTreeNode *x, double *
   return 0;
 }
 
+// ================================================================================
+//
+// name:          FrequencyDecisionGraph::countSplitFrequencies
+//
+// function:      counts the instances of a node for the given splits on it by
+//                intersecting the bit columns of the population with the bitset of
+//                the instances in the node (the counts are not divided by N); the
+//                weights of the instances are counted a bit at a time, each bit
+//                with the instances that have got it (those are in the first
+//                words for the high bits, see compressPopulation)
+//
+// parameters:    x...............the active node
+//                candidate.......(see computeSplitFrequencies)
+//                numCandidates...(see computeSplitFrequencies)
+//                left0...........(see computeSplitFrequencies)
+//                left1...........(see computeSplitFrequencies)
+//                right0..........(see computeSplitFrequencies)
+//                right1..........(see computeSplitFrequencies)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int FrequencyDecisionGraph::countSplitFrequencies(LabeledTreeNode *x, SplitCandidate *candidate, int numCandidates, double *left0, double *left1, double *right0, double *right1)
+{
+  long i;
+  long j;
+  long numWords;
+  long bitWords;
+  long total,numOnes;
+  long count,count1;
+  uint64_t stackWords[4*MAX_STACK_WORDS];
+  uint64_t *leaf;
+  uint64_t *leafOnes;
+  uint64_t *bitLeaf;
+  uint64_t *bitLeafOnes;
+  int numPasses;
+  int b;
+  int c;
+
+  // set helper variables
+
+  numWords  = p->numWords;
+  numPasses = (p->numWeightBits>0)? p->numWeightBits:1;
+
+  // the bitset of the instances in x and of those among them with 1 on our
+  // position (and the same for those with a particular bit of the weight)
+
+  if (numWords<=MAX_STACK_WORDS)
+    {
+      leaf = stackWords;
+      memset(leaf,0,4*numWords*sizeof(uint64_t));
+    }
+  else
+    leaf = (uint64_t*) Calloc(4*numWords,sizeof(uint64_t));
+
+  leafOnes    = leaf+numWords;
+  bitLeaf     = leaf+2*numWords;
+  bitLeafOnes = leaf+3*numWords;
+
+  for (i=0; i<x->numInstances; i++)
+    {
+      j = x->instance[i];
+      leaf[j>>6] |= ((uint64_t) 1)<<(j&63);
+    }
+
+  if (myPosition>=0)
+    for (i=0; i<numWords; i++)
+      leafOnes[i] = leaf[i]&p->column[myPosition][i];
+
+  // count the instances with 1 on the label (all and with 1 on our position),
+  // for each bit of the weights (the counts of right0 and right1 are those
+  // with 1 on the label for now)
+
+  total = numOnes = 0;
+
+  for (b=0; b<numPasses; b++)
+    {
+      if (p->numWeightBits>0)
+	{
+	  bitWords = p->weightWords[b];
+
+	  for (i=0; i<bitWords; i++)
+	    {
+	      bitLeaf[i]     = leaf[i]&p->weightBit[b][i];
+	      bitLeafOnes[i] = leafOnes[i]&p->weightBit[b][i];
+	    }
+	}
+      else
+	{
+	  bitWords    = numWords;
+	  bitLeaf     = leaf;
+	  bitLeafOnes = leafOnes;
+	}
+
+      // (the ones of the leaf are among its instances, so intersecting the
+      // leaf with itself and with the ones gives both counts)
+
+      countAndBits(bitLeaf,bitLeaf,bitLeafOnes,bitWords,&count,&count1);
+
+      total   += count<<b;
+      numOnes += count1<<b;
+
+      for (c=0; c<numCandidates; c++)
+	{
+	  countAndBits(p->column[candidate[c].label],bitLeaf,bitLeafOnes,bitWords,&count,&count1);
+
+	  right0[c] += count<<b;
+	  right1[c] += count1<<b;
+	}
+    }
+
+  // now the frequencies of the splits
+
+  for (c=0; c<numCandidates; c++)
+    {
+      count  = (long) right0[c];
+      count1 = (long) right1[c];
+
+      if (myPosition>=0)
+	{
+	  left1[c]  = numOnes-count1;
+	  left0[c]  = total-count-left1[c];
+	  right1[c] = count1;
+	  right0[c] = count-count1;
+	}
+      else
+	{
+	  left0[c]  = total-count;
+	  right0[c] = count;
+	}
+    }
+
+  // free the bitsets
+
+  if (leaf!=stackWords)
+    Free(leaf);
+
+  // get back
+
+  return 0;
+}
+
 // ================================================================================
 //
 // name:          FrequencyDecisionGraph::print
@@ -13,20 +13,22 @@ class FrequencyDecisionGraph: public DecisionGraph
   Population *p;
   int         myPosition;
 
+  int    setAllInstances(LabeledTreeNode *x);
+  int    countSplitFrequencies(LabeledTreeNode *x, SplitCandidate *candidate, int numCandidates, double *left0, double *left1, double *right0, double *right1);
   double univariateFrequency(int k);
   double instanceFrequency(int *index, char *x, int n);
 
   int recursivePrint(FILE *out, LabeledTreeNode *x, int shift);
   
  public:
-  FrequencyDecisionGraph(Population *p);
-  FrequencyDecisionGraph(Population *p, int myPosition);
+  FrequencyDecisionGraph(Population *p, Arena *arena=NULL);
+  FrequencyDecisionGraph(Population *p, int myPosition, Arena *arena=NULL);
   
   int merge(LabeledTreeNode *x, LabeledTreeNode *y);
   int split(LabeledTreeNode *x, int label);
 
   int computeFrequencies();
-  int computeSplitFrequencies(LabeledTreeNode *x, double *left0, double *left1, double *right0, double *right1);
+  int computeSplitFrequencies(LabeledTreeNode *x, SplitCandidate *candidate, int numCandidates, double *left0, double *left1, double *right0, double *right1);
 
   // print out the graph, starting from the root
 
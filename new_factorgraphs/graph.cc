@@ -16,9 +16,12 @@
 
 #include "graph.h"
 #include "memalloc.h"
-#include "stack.h"
 #include "utils.h"
 
+#define PATH_BIT(i)      (((uint64_t) 1)<<((i)&63))
+#define PATH_WORD(i)     ((i)>>6)
+#define IS_PATH(row,i)   (((row)[PATH_WORD(i)]&PATH_BIT(i))!=0)
+
 //==========================================================
 //==========================================================
 //==========================================================
@@ -31,20 +34,26 @@ OrientedGraph::OrientedGraph(int n)
 
   N=n;
   N2=N*N;
+  numWords=(N+63)/64;
 
-  // allocate memory for coincidence, path, and parentList matrices
+  // allocate memory for coincidence, path (its rows are bitsets), and
+  // parentList matrices
 
   coincidence = (char**) Calloc(N,sizeof(char*));
-  path = (char**) Calloc(N,sizeof(char*));
+  path = (uint64_t**) Calloc(N,sizeof(uint64_t*));
   parentList = (int**) Calloc(N,sizeof(int*));
 
   for (i=0; i<N; i++)
     {
       coincidence[i] = (char*) Calloc(N,sizeof(char));
-      path[i]        = (char*) Calloc(N,sizeof(char));
+      path[i]        = (uint64_t*) Calloc(numWords,sizeof(uint64_t));
       parentList[i]  = (int*) Calloc(N,sizeof(int));
     }
 
+  // allocate memory for the vertices affected by removing an edge
+
+  affected = (int*) Calloc(N,sizeof(int));
+
   // allocate memory for the number of incoming and outcoming edges
 
   numIn = (int*) Calloc(N,sizeof(int));
@@ -87,9 +96,10 @@ OrientedGraph::~OrientedGraph()
   Free(numIn);
   Free(numOut);
 
-  // free the memory used by vertex-marks
+  // free the memory used by vertex-marks and the affected vertices
 
   Free(mark);
+  Free(affected);
 }
 
 //==========================================================
@@ -104,6 +114,7 @@ int OrientedGraph::size()
 int OrientedGraph::addEdge(int i, int j)
 {
   register int k,l;
+  uint64_t *from;
 
   // is the edge already present?
 
@@ -116,15 +127,17 @@ int OrientedGraph::addEdge(int i, int j)
   parentList[j][numIn[j]]=i;
   numOut[i]++;
   numIn[j]++;
-  path[i][j]=CONNECTED;
+  path[i][PATH_WORD(j)] |= PATH_BIT(j);
 
-  // update the path matrix
+  // update the path matrix (whatever gets to i gets everywhere j gets, a word
+  // of the row at a time)
+
+  from = path[j];
 
   for (k=0; k<N; k++)
-  if (path[k][i])
-     for (l=0; l<N; l++)
-         if ((l!=k)&&(path[j][l]))
-            path[k][l]=CONNECTED;
+    if (IS_PATH(path[k],i))
+      for (l=0; l<numWords; l++)
+	path[k][l] |= from[l];
 
   return SUCCESS;
 }
@@ -133,23 +146,17 @@ int OrientedGraph::addEdge(int i, int j)
 
 int OrientedGraph::removeEdge(int i, int j)
 {
-  int k;
-  register int l,m;
-  char added;
-  IntStack *from,*to,*from2,*to2;
+  int  k,l;
+  int  numAffected;
+  int  c,w;
+  char changed;
+  uint64_t old;
 
   // is the edge present?
 
   if (!coincidence[i][j])
      return SUCCESS;
 
-  // initialize stacks (needed later)
-
-  from  = new IntStack((int)N2);
-  to    = new IntStack((int)N2);
-  from2 = new IntStack((int)N2);
-  to2   = new IntStack((int)N2);
-
   // remove the edge
 
   coincidence[i][j]=NOT_CONNECTED;
@@ -165,56 +172,41 @@ int OrientedGraph::removeEdge(int i, int j)
 
   // update the path matrix
 
-  // a) remove all paths that could possibly be wrong
+  // a) only the paths of the vertices getting to i could have gone through
+  //    the edge, so those start from scratch (each vertex gets to itself)
 
+  numAffected=0;
   for (k=0; k<N; k++)
-    if (path[k][i])
-      for (l=0; l<N; l++)
-	if ((l!=k)&&(!coincidence[k][l])&&(path[j][l]))
-	  {
-	    path[k][l]=0;
-	    from->push(k);
-	    to->push(l);
-	  }
+    if (IS_PATH(path[k],i))
+      {
+	affected[numAffected++]=k;
 
-  // b) add all paths that were potentially removed incorrectly
+	for (l=0; l<numWords; l++)
+	  path[k][l]=0;
+	path[k][PATH_WORD(k)] |= PATH_BIT(k);
+      }
+
+  // b) add the paths of the children to their parents until nothing changes
+  //    (the rows of the vertices not affected are correct already)
 
   do
     {
-      added=0;
+      changed=0;
 
-      while (from->notEmpty())
+      for (c=0; c<numAffected; c++)
 	{
-	  k=from->pop();
-	  l=to->pop();
-	  
-	  for (m=0; m<N; m++)
-	    if ((path[k][m])&&(path[m][l]))
-	      {
-		path[k][l]=CONNECTED;
-		added=1;
-	      }
-
-	  if (!path[k][l])
-	    {
-	      from2->push(k);
-	      to2->push(l);
-	    }
+	  k=affected[c];
+
+	  for (l=0; l<N; l++)
+	    if (coincidence[k][l])
+	      for (w=0; w<numWords; w++)
+		{
+		  old         = path[k][w];
+		  path[k][w] |= path[l][w];
+		  changed    |= (path[k][w]!=old);
+		}
 	}
-
-      // swap stacks
-
-      swapPointers((void**) &from, (void**) &from2);
-      swapPointers((void**) &to, (void**) &to2);
-
-    } while (added);
-
-  // free used stacks
-
-  delete from;
-  delete to;
-  delete from2;
-  delete to2;
+    } while (changed);
 
   // get back
 
@@ -247,11 +239,13 @@ int OrientedGraph::removeAllEdges()
 {
   for (int i=0; i<N; i++)
   {
-    path[i][i]=CONNECTED;
+    for (int w=0; w<numWords; w++)
+      path[i][w]=0;
+    path[i][PATH_WORD(i)]=PATH_BIT(i);
     numIn[i]=0;
     numOut[i]=0;
     for (int j=0; j<i; j++)
-      coincidence[i][j]=coincidence[j][i]=path[i][j]=path[j][i]=NOT_CONNECTED;
+      coincidence[i][j]=coincidence[j][i]=NOT_CONNECTED;
   }
 
   return SUCCESS;
@@ -315,7 +309,7 @@ int OrientedGraph::notConnected(int i, int j)
 
 int OrientedGraph::existsPath(int i, int j)
 {
-  return (path[i][j]);
+  return IS_PATH(path[i],j);
 }
 
 //==========================================================
@@ -380,7 +374,7 @@ int  OrientedGraph::printPathMatrix(FILE *out)
   for (i=0; i<N; i++)
     {
       for (j=0; j<N; j++)
-	fprintf(out,"%u ",path[i][j]);
+	fprintf(out,"%u ",IS_PATH(path[i],j));
       fprintf(out,"\n");
     }
   
@@ -2,6 +2,7 @@
 #define _graph_h_
 
 #include <stdio.h>
+#include <stdint.h>
 
 #define CONNECTED      1
 #define NOT_CONNECTED  0
@@ -17,8 +18,10 @@ class OrientedGraph {
 
   int  N;              // the number of vertices
   long N2;             // N square
+  int  numWords;       // the number of 64-bit words in a row of the path matrix
   char **coincidence;  // the coincidence matrix
-  char **path;         // the matrix for maintanance of paths
+  uint64_t **path;     // the matrix for maintanance of paths (a bit per vertex)
+  int  *affected;      // the vertices whose paths are recomputed by removeEdge
   int  *numIn;         // the number of incoming vertices
   int  *numOut;        // the number of outcoming vertices
   int  *mark;          // the array for vertex-marks
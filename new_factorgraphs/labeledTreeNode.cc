@@ -48,13 +48,20 @@ LabeledTreeNode::LabeledTreeNode(int type)
   leavesItem=NULL;
   leafParentsItem=NULL;
 
-  parentLabelCoincidenceVector=NULL;
+  parentLabels=NULL;
 
-  dArrayTmp = NULL;
-  rightValue0Array = NULL;
-  rightValue1Array = NULL;
-  leftValue0Array  = NULL;
-  leftValue1Array  = NULL;
+  instance=NULL;
+  numInstances=0;
+  ownsInstances=0;
+
+  candidate     = NULL;
+  numCandidates = 0;
+  candidateSize = 0;
+
+  bestCandidate = -1;
+  queuePosition = -1;
+
+  samplerIndex  = -1;
 }
 
 // ================================================================================
@@ -72,26 +79,20 @@ LabeledTreeNode::LabeledTreeNode(int type)
 LabeledTreeNode::~LabeledTreeNode()
 {
 
-  if (parentLabelCoincidenceVector)
-    free(parentLabelCoincidenceVector);
-  if (dArrayTmp)
-    free(dArrayTmp);
-  if (rightValue0Array)
-    free(rightValue0Array);
-  if (rightValue1Array)
-    free(rightValue1Array);
-  if (leftValue0Array)
-    free(leftValue0Array);
-  if (leftValue1Array)
-    free(leftValue1Array);
+  if (parentLabels)
+    free(parentLabels);
+  if (ownsInstances)
+    free(instance);
+  if (candidate)
+    free(candidate);
 }
 
 // ================================================================================
 //
 // name:          LabeledTreeNode::~LabeledTreeNode
 //
-// function:      allocates a coincidence vector containing 1's for all ancestors
-//                in a decision graph
+// function:      allocates a bitset with 1's for the labels of all ancestors in
+//                a decision graph
 //
 // parameters:    n......the number of possible values (labels) of ancestors
 //
@@ -101,7 +102,7 @@ LabeledTreeNode::~LabeledTreeNode()
 
 int LabeledTreeNode::allocateInstanceIndexEntries(int n)
 {
-  parentLabelCoincidenceVector = (char*) Calloc(n,sizeof(char));
+  parentLabels = (uint64_t*) Calloc((n+63)/64,sizeof(uint64_t));
 
   // get back
 
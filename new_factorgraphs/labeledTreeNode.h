@@ -2,6 +2,16 @@
 #define _labeledTreeNode_h_
 
 #include <stdio.h>
+#include <stdint.h>
+
+// -------------------------------------
+// a split that can be done on a leaf
+// -------------------------------------
+
+struct SplitCandidate {
+  int    label;
+  double gain;
+};
 
 // -------------------------------------
 // well must polish this at some point
@@ -19,13 +29,20 @@ class LabeledTreeNode {
   void *leavesItem;
   void *leafParentsItem;
 
-  char *parentLabelCoincidenceVector;
+  uint64_t *parentLabels; // bit i set if there's a split on i above this node
+
+  long *instance;         // the instances (strings) that get to this leaf
+  long  numInstances;
+  char  ownsInstances;    // is instance our own block (or a part of the parent's)?
+
+  SplitCandidate *candidate;  // the splits we can do, in increasing order of labels
+  int     numCandidates;
+  int     candidateSize;  // how many candidates fit in
+
+  int     bestCandidate;  // the best split of this leaf (see operatorQueue.cc)
+  int     queuePosition;  // where in the queue of the splits the leaf is (-1 if not in it)
 
-  double *dArrayTmp;
-  double *rightValue0Array;
-  double *rightValue1Array;
-  double *leftValue0Array;
-  double *leftValue1Array;
+  int     samplerIndex;   // where in the compiled sampler the node is (-1 if not in it)
 
   int             numParents;
   LabeledTreeNode **parent;
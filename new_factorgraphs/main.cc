@@ -28,6 +28,8 @@ ParamStruct params[] =
 {
   {PARAM_LONG,"populationSize",&boaParams.N,"1200","Size of the population",NULL},
   {PARAM_FLOAT,"offspringPercentage",&boaParams.percentOffspring,"50","Size of offspring to create (% from population)",NULL},
+  {PARAM_FLOAT,"elitePercentage",&boaParams.percentElite,"0","Best of the population never replaced (% from population)",NULL},
+  {PARAM_FLOAT,"maxReplacedPercentage",&boaParams.maxReplacedPercent,"100","Max. part of the population replaced per generation (%)",NULL},
 
   {PARAM_DIVIDER,NULL,NULL,NULL,NULL,NULL},  
 
@@ -47,6 +49,20 @@ ParamStruct params[] =
 
   {PARAM_INT,"maxIncoming",&boaParams.maxIncoming,"20","Maximal number of incoming edges in dep. graph for the BOA",NULL},
   {PARAM_CHAR,"allowMerge",&boaParams.allowMerge,"0","Allow a merge operator?",&yesNoDescriptor},
+  {PARAM_INT,"modelBuildMode",&boaParams.modelBuildMode,"0","Operators per round of model building (0=the best one, 1=best of each variable)",NULL},
+
+  {PARAM_DIVIDER,NULL,NULL,NULL,NULL,NULL},
+
+  {PARAM_INT,"wakeTableMode",&boaParams.wakeTableMode,"0","Wake interaction table (0=none, 1=site pairs, 2=grid offsets)",NULL},
+  {PARAM_INT,"wakeOverlapMode",&boaParams.wakeOverlapMode,"0","Rotor-wake overlap (0=10 sampled points, 1=exact segment, 2=exact disc area)",NULL},
+  {PARAM_FLOAT,"windRoseMaxError",&boaParams.windRoseMaxError,"0","Max. efficiency error from dropping wind rose bins (0 is keep all)",NULL},
+  {PARAM_INT,"deficitKernel",&boaParams.deficitKernel,"0","Wake deficit kernel (0=best available, 1=scalar, 2=AVX2, 3=AVX-512)",NULL},
+
+  {PARAM_DIVIDER,NULL,NULL,NULL,NULL,NULL},
+
+  {PARAM_INT,"numThreads",&boaParams.numThreads,"1","Number of threads (0 is one per processor)",NULL},
+  {PARAM_LONG,"fitnessCacheSize",&boaParams.fitnessCacheSize,"0","Number of strings in the fitness cache (0 is no cache)",NULL},
+  {PARAM_INT,"bitCountKernel",&boaParams.bitCountKernel,"0","Bit count kernel (0=best available, 1=scalar, 2=popcnt, 3=AVX2)",NULL},
 
   {PARAM_DIVIDER,NULL,NULL,NULL,NULL,NULL},
 
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <malloc.h>
 #include <stdio.h>
+#include <string.h>
 
 // inline functions
 
@@ -39,6 +40,34 @@ inline void *Calloc(long x, int s)
    return p;
 }
 
+inline void *AlignedCalloc(long x, int s, int alignment)
+{
+   void *p;
+
+   if (posix_memalign(&p,alignment,x*s))
+   {
+      printf("ERROR: Not enough memory. (for a block of size %lu)\n",x*s);
+      exit(-1);
+   }
+
+   memset(p,0,x*s);
+
+   return p;
+}
+
+inline void *Realloc(void *p, long x, int s)
+{
+   p=realloc(p,x*s);
+
+   if ((p==NULL)&&(x*s>0))
+   {
+      printf("ERROR: Not enough memory. (for a block of size %lu)\n",x*s);
+      exit(-1);
+   }
+
+   return p;
+}
+
 inline void Free(void *x)
 {
   free(x);
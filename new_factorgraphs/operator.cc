@@ -16,8 +16,11 @@
 
 #include "bayesian.h"
 #include "operator.h"
+#include "operatorQueue.h"
 #include "memalloc.h"
 
+static int compareOperators(const void *a, const void *b);
+
 // ================================================================================
 //
 // name:          resetOperator
@@ -77,11 +80,12 @@ int updateBestOperator(Operator *best, Operator *x)
 //
 // name:          updateBestNodeOperator
 //
-// function:      updates the best operator for a node (just go through all
-//                operators we can do and then pick the best one)
+// function:      updates the best operator for a node (take the best split from
+//                the queue of the leaves and then try all merges)
 //
 // parameters:    x..........the best operator for this variable
 //                t..........the corresponding frequency graph
+//                splits.....the queue of the leaves of the graph
 //                merge......merge operators for this variable
 //                numMerge...number of merge operators for the variable
 //                
@@ -89,36 +93,31 @@ int updateBestOperator(Operator *best, Operator *x)
 //
 // ================================================================================
 
-int updateBestNodeOperator(Operator *x, FrequencyDecisionGraph *t, MergeOperator *merge, int numMerges, int node, int n)
+int updateBestNodeOperator(Operator *x, FrequencyDecisionGraph *t, SplitQueue *splits, MergeOperator *merge, int numMerges, int node)
 {
-  int i,j;
-  int numLeaves;
-  NodeListItem *leafItem;
+  int i;
+  LabeledTreeNode *leaf;
 
   //  printf("Updating best gain for node %u (%u + %u)\n",node,t->getNumLeaves(),numMerges);
 
-  // assign some helper variables
-
-  numLeaves = t->getNumLeaves();
-
   // reset the operator
 
   resetOperator(x);
 
-  // try all splits, and update the best oeprator for this node
+  // take the best split (if it gains more than the reset operator)
 
-  for (i=0, leafItem=t->getLeaves(); (i<numLeaves); i++, leafItem=leafItem->next)
-    for (j=0; j<n; j++)
-      if (x->gain<leafItem->x->dArrayTmp[j])
-	{
-	  x->gain  = leafItem->x->dArrayTmp[j];
-	  x->type  = OPERATOR_SPLIT_NODE;
-	  x->where = node;
-	  x->label = j;
-	  x->node  = leafItem->x;
-	  x->node2 = NULL;
-	  x->t     = t;
-	};
+  leaf = getBestSplitLeaf(splits);
+
+  if ((leaf!=NULL)&&(x->gain<leaf->candidate[leaf->bestCandidate].gain))
+    {
+      x->gain  = leaf->candidate[leaf->bestCandidate].gain;
+      x->type  = OPERATOR_SPLIT_NODE;
+      x->where = node;
+      x->label = leaf->candidate[leaf->bestCandidate].label;
+      x->node  = leaf;
+      x->node2 = NULL;
+      x->t     = t;
+    };
 
   // try all merges
 
@@ -159,20 +158,6 @@ int applyOperator(Operator *x, AcyclicOrientedGraph *G)
   switch (x->type) {
   case OPERATOR_SPLIT_NODE: 
     x->t->split(x->node,x->label);
-    x->node->left->dArrayTmp = (double*) Calloc(G->size(),sizeof(double));
-    x->node->left->rightValue0Array = (double*) Calloc(G->size(),sizeof(double));
-    x->node->left->rightValue1Array = (double*) Calloc(G->size(),sizeof(double));
-    x->node->left->leftValue0Array = (double*) Calloc(G->size(),sizeof(double));
-    x->node->left->leftValue1Array = (double*) Calloc(G->size(),sizeof(double));
-    x->node->right->dArrayTmp = (double*) Calloc(G->size(),sizeof(double));
-    x->node->right->rightValue0Array = (double*) Calloc(G->size(),sizeof(double));
-    x->node->right->rightValue1Array = (double*) Calloc(G->size(),sizeof(double));
-    x->node->right->leftValue0Array = (double*) Calloc(G->size(),sizeof(double));
-    x->node->right->leftValue1Array = (double*) Calloc(G->size(),sizeof(double));
-    x->node->left->value[0]=x->node->leftValue0Array[x->label];
-    x->node->left->value[1]=x->node->leftValue1Array[x->label];
-    x->node->right->value[0]=x->node->rightValue0Array[x->label];
-    x->node->right->value[1]=x->node->rightValue1Array[x->label];
     ///!    if (x->node->depth+1>getMaxDepth())
     ///!      setMaxDepth(x->node->depth+1);
     G->addEdge(x->label,x->where);
@@ -195,41 +180,146 @@ int applyOperator(Operator *x, AcyclicOrientedGraph *G)
 
 // ================================================================================
 //
-// name:          updateGainsAfterOperator
+// name:          updateGainsAfterOperators
 //
-// function:      updates gains after applying an operator to the network
+// function:      updates gains after applying a number of operators to the network
+//                (each on a different variable); the gains of all the leaves they
+//                touched are computed at the same time
 //
-// parameters:    x............the operator
-//                G............the network
-//                maxParents...the bound on the number of parents
-//                N............population size
+// parameters:    x..............the operators
+//                numOperators...the number of the operators
+//                G..............the network
+//                splits.........the queues of the leaves of all the graphs
+//                maxParents.....the bound on the number of parents
+//                N..............population size
 //                
 // returns:       (int) 0
 //
 // ================================================================================
 
-int updateGainsAfterOperator(Operator *x, AcyclicOrientedGraph *G, int maxParents, long N)
+int updateGainsAfterOperators(Operator *x, int numOperators, AcyclicOrientedGraph *G, SplitQueue *splits, int maxParents, long N)
 {
-   switch (x->type) {
-   case OPERATOR_SPLIT_NODE: 
-     recomputeDecisionGraphSplitGains(x->t,x->node->left,G,maxParents,x->where,G->size(),N);
-     recomputeDecisionGraphSplitGains(x->t,x->node->right,G,maxParents,x->where,G->size(),N);
-     break;
+   FrequencyDecisionGraph **t;
+   LabeledTreeNode        **leaf;
+   int                    *node;
+   int                    numLeaves;
+   int                    i;
 
-   case OPERATOR_MERGE_NODE:
-     recomputeDecisionGraphSplitGains(x->t,x->node,G,maxParents,x->where,G->size(),N);
-     break;
+   t    = (FrequencyDecisionGraph**) Calloc(2*numOperators,sizeof(FrequencyDecisionGraph*));
+   leaf = (LabeledTreeNode**) Calloc(2*numOperators,sizeof(LabeledTreeNode*));
+   node = (int*) Calloc(2*numOperators,sizeof(int));
 
+   // take the nodes that are gone out of the queues (before the gains of the
+   // leaves in the same queues change) and collect the leaves whose gains
+   // have changed
 
-  default:
-    printf("ERROR: Operator not defined (updateGainsAfterOperator)! Exiting!\n");
-  };
+   numLeaves = 0;
+   for (i=0; i<numOperators; i++)
+     switch (x[i].type) {
+     case OPERATOR_SPLIT_NODE:
+       // the split node is no leaf anymore, its children are
+
+       removeFromSplitQueue(&(splits[x[i].where]),x[i].node);
+
+       t[numLeaves]      = t[numLeaves+1]    = x[i].t;
+       node[numLeaves]   = node[numLeaves+1] = x[i].where;
+       leaf[numLeaves++] = x[i].node->left;
+       leaf[numLeaves++] = x[i].node->right;
+       break;
+
+     case OPERATOR_MERGE_NODE:
+       // the second node is gone
+
+       removeFromSplitQueue(&(splits[x[i].where]),x[i].node2);
+
+       t[numLeaves]      = x[i].t;
+       node[numLeaves]   = x[i].where;
+       leaf[numLeaves++] = x[i].node;
+       break;
+
+     default:
+       printf("ERROR: Operator not defined (updateGainsAfterOperators)! Exiting!\n");
+     };
+
+   // the leaves are done at the same time
+
+   recomputeSplitGainsInParallel(numLeaves,t,leaf,node,G,maxParents,G->size(),N);
+
+   // put them in their queues
+
+   for (i=0; i<numLeaves; i++)
+     updateSplitQueue(&(splits[node[i]]),leaf[i]);
+
+   Free(t);
+   Free(leaf);
+   Free(node);
 
   // get back
 
   return 0;
 }
 
+// ================================================================================
+//
+// name:          getOperatorBatch
+//
+// function:      takes the best operators of all the variables that gain
+//                something, the best ones first (the lower variable first if
+//                they gain the same); they touch different decision graphs, but
+//                they still must be checked one after another to be applicable
+//
+// parameters:    best.........the best operator of each variable
+//                n............the number of variables
+//                batch........the operators taken (output)
+//                
+// returns:       (int) the number of the operators taken
+//
+// ================================================================================
+
+int getOperatorBatch(Operator *best, int n, Operator *batch)
+{
+  int i;
+  int numOperators;
+
+  numOperators = 0;
+  for (i=0; i<n; i++)
+    if (best[i].gain>0)
+      memcpy(&(batch[numOperators++]),&(best[i]),sizeof(Operator));
+
+  qsort(batch,numOperators,sizeof(Operator),&compareOperators);
+
+  // get back
+
+  return numOperators;
+}
+
+// ================================================================================
+//
+// name:          compareOperators
+//
+// function:      compares two operators for qsort (a better gain goes first, the
+//                lower variable if the gains are the same)
+//
+// parameters:    a............the first operator
+//                b............the second operator
+//                
+// returns:       (int) negative if a goes first, positive if b does
+//
+// ================================================================================
+
+static int compareOperators(const void *a, const void *b)
+{
+  const Operator *x,*y;
+
+  x = (const Operator*) a;
+  y = (const Operator*) b;
+
+  if (x->gain!=y->gain)
+    return (x->gain>y->gain)? -1:1;
+
+  return x->where-y->where;
+}
+
 // ================================================================================
 //
 // name:          operatorApplicable
@@ -268,17 +358,36 @@ int operatorApplicable(Operator *x, AcyclicOrientedGraph *G)
 //                not on merges, but splits
 //
 // parameters:    x............the operator
+//                splits.......the queue of the leaves of the graph
 //                
 // returns:       (int) 0
 //
 // ================================================================================
 
-int deleteOperator(Operator *x)
+int deleteOperator(Operator *x, SplitQueue *splits)
 {
-  // well, if it's the split, set the corresponding gain to -1
+  int first,last,middle;
+
+  // well, if it's the split, set the corresponding gain to -1 (the candidates
+  // are sorted by their labels)
 
   if (x->type==OPERATOR_SPLIT_NODE)
-    x->node->dArrayTmp[x->label]=-1;
+    {
+      first = 0;
+      last  = x->node->numCandidates-1;
+
+      while (first<last)
+	{
+	  middle = (first+last)/2;
+	  if (x->node->candidate[middle].label<x->label)
+	    first = middle+1;
+	  else
+	    last = middle;
+	}
+
+      x->node->candidate[first].gain=-1;
+      updateSplitQueue(splits,x->node);
+    }
 
   // get back
   
@@ -25,12 +25,15 @@ struct MergeOperator {
   LabeledTreeNode *b;
 };
 
+struct SplitQueue;
+
 int resetOperator(Operator *x);
 int updateBestOperator(Operator *best, Operator *x);
-int updateBestNodeOperator(Operator *x, FrequencyDecisionGraph *t, MergeOperator *merge, int numMerges, int node, int n);
+int updateBestNodeOperator(Operator *x, FrequencyDecisionGraph *t, SplitQueue *splits, MergeOperator *merge, int numMerges, int node);
 int applyOperator(Operator *x, AcyclicOrientedGraph *G);
-int updateGainsAfterOperator(Operator *x, AcyclicOrientedGraph *G, int maxParents, long N);
+int updateGainsAfterOperators(Operator *x, int numOperators, AcyclicOrientedGraph *G, SplitQueue *splits, int maxParents, long N);
+int getOperatorBatch(Operator *best, int n, Operator *batch);
 int operatorApplicable(Operator *x, AcyclicOrientedGraph *G);
-int deleteOperator(Operator *x);
+int deleteOperator(Operator *x, SplitQueue *splits);
 
 #endif
@@ -0,0 +1,565 @@
+// ################################################################################
+//
+// name:          operatorQueue.cc
+//
+// purpose:       heaps for picking the best operator while the network is being
+//                constructed: the leaves of each decision graph by the gains of
+//                their best splits and the variables by the gains of their best
+//                operators; only what an operator touched is moved around then
+//
+// ################################################################################
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "operatorQueue.h"
+#include "decisionGraph.h"
+#include "memalloc.h"
+
+static int splitBetter(LabeledTreeNode *a, int i, LabeledTreeNode *b, int j);
+static int leafBetter(LabeledTreeNode *a, LabeledTreeNode *b);
+static int splitQueueUp(SplitQueue *q, int k);
+static int splitQueueDown(SplitQueue *q, int k);
+
+static int nodeBetter(NodeQueue *q, int a, int b);
+static int nodeQueueUp(NodeQueue *q, int k);
+static int nodeQueueDown(NodeQueue *q, int k);
+
+// ================================================================================
+//
+// name:          splitBetter
+//
+// function:      compares two splits the way the search for the best one used to
+//                scan them (leaves in the order of the list, labels in increasing
+//                order, the best gain so far kept as a float, the labels that
+//                could not be split on having a gain of -1); the gains are
+//                compared as floats, then a gain above its float beats the one
+//                that isn't, the later of those above wins and the earlier of
+//                those that are not
+//
+// parameters:    a............the leaf of the first split
+//                i............the candidate of the first split
+//                b............the leaf of the second split
+//                j............the candidate of the second split
+//
+// returns:       (int) 1 if the first split is better, 0 otherwise
+//
+// ================================================================================
+
+static int splitBetter(LabeledTreeNode *a, int i, LabeledTreeNode *b, int j)
+{
+  double gainA,gainB;
+  float  floatA,floatB;
+  char   aboveA,aboveB;
+  unsigned long long orderA,orderB;
+  int    labelA,labelB;
+  char   later;
+
+  gainA  = a->candidate[i].gain;
+  gainB  = b->candidate[j].gain;
+  floatA = (float) gainA;
+  floatB = (float) gainB;
+
+  if (floatA!=floatB)
+    return (floatA>floatB);
+
+  aboveA = (gainA>floatA);
+  aboveB = (gainB>floatB);
+
+  if (aboveA!=aboveB)
+    return aboveA;
+
+  // which one is later in the scan?
+
+  orderA = ((NodeListItem*) a->leavesItem)->order;
+  orderB = ((NodeListItem*) b->leavesItem)->order;
+  labelA = a->candidate[i].label;
+  labelB = b->candidate[j].label;
+
+  if (orderA!=orderB)
+    later = (orderA>orderB);
+  else
+    if (labelA!=labelB)
+      later = (labelA>labelB);
+    else
+      return 0;
+
+  return (aboveA)? later:!later;
+}
+
+// ================================================================================
+//
+// name:          leafBetter
+//
+// function:      compares two leaves by their best splits
+//
+// parameters:    a............the first leaf
+//                b............the second leaf
+//
+// returns:       (int) 1 if the first leaf is better, 0 otherwise
+//
+// ================================================================================
+
+static int leafBetter(LabeledTreeNode *a, LabeledTreeNode *b)
+{
+  return splitBetter(a,a->bestCandidate,b,b->bestCandidate);
+}
+
+// ================================================================================
+//
+// name:          initializeSplitQueue
+//
+// function:      allocates an empty queue of leaves
+//
+// parameters:    q............the queue
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int initializeSplitQueue(SplitQueue *q)
+{
+  q->size      = 16;
+  q->numLeaves = 0;
+  q->leaf      = (LabeledTreeNode**) Calloc(q->size,sizeof(LabeledTreeNode*));
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          doneSplitQueue
+//
+// function:      frees the queue of leaves
+//
+// parameters:    q............the queue
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int doneSplitQueue(SplitQueue *q)
+{
+  Free(q->leaf);
+
+  q->leaf      = NULL;
+  q->numLeaves = q->size = 0;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          updateSplitQueue
+//
+// function:      finds the best split of a leaf after its gains have changed and
+//                moves it to its place in the queue (it's added if not in yet,
+//                and removed if it's got no splits to do)
+//
+// parameters:    q............the queue
+//                x............the leaf
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int updateSplitQueue(SplitQueue *q, LabeledTreeNode *x)
+{
+  int c;
+  int k;
+
+  // a leaf with no splits doesn't belong here
+
+  if (x->numCandidates==0)
+    return removeFromSplitQueue(q,x);
+
+  // the best split of the leaf
+
+  x->bestCandidate = 0;
+  for (c=1; c<x->numCandidates; c++)
+    if (splitBetter(x,c,x,x->bestCandidate))
+      x->bestCandidate = c;
+
+  // add it at the end if it's not in yet
+
+  if (x->queuePosition<0)
+    {
+      if (q->numLeaves==q->size)
+	{
+	  q->size *= 2;
+	  q->leaf  = (LabeledTreeNode**) Realloc(q->leaf,q->size,sizeof(LabeledTreeNode*));
+	}
+
+      x->queuePosition        = q->numLeaves;
+      q->leaf[q->numLeaves++] = x;
+    }
+
+  // move it where it belongs
+
+  k = x->queuePosition;
+
+  splitQueueUp(q,k);
+  if (x->queuePosition==k)
+    splitQueueDown(q,k);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          removeFromSplitQueue
+//
+// function:      removes a leaf from the queue (it's been split or merged into
+//                another leaf)
+//
+// parameters:    q............the queue
+//                x............the leaf
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int removeFromSplitQueue(SplitQueue *q, LabeledTreeNode *x)
+{
+  int k;
+  LabeledTreeNode *last;
+
+  if (x->queuePosition<0)
+    return 0;
+
+  // put the last leaf in its place
+
+  k    = x->queuePosition;
+  last = q->leaf[--q->numLeaves];
+
+  x->queuePosition = -1;
+
+  if (last!=x)
+    {
+      q->leaf[k]          = last;
+      last->queuePosition = k;
+
+      splitQueueUp(q,k);
+      if (last->queuePosition==k)
+	splitQueueDown(q,k);
+    }
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          getBestSplitLeaf
+//
+// function:      returns the leaf with the best split
+//
+// parameters:    q............the queue
+//
+// returns:       (LabeledTreeNode*) the leaf (NULL if the queue is empty)
+//
+// ================================================================================
+
+LabeledTreeNode *getBestSplitLeaf(SplitQueue *q)
+{
+  return (q->numLeaves>0)? q->leaf[0]:NULL;
+}
+
+// ================================================================================
+//
+// name:          splitQueueUp
+//
+// function:      moves a leaf up the heap while it's better than its parent
+//
+// parameters:    q............the queue
+//                k............the position of the leaf
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int splitQueueUp(SplitQueue *q, int k)
+{
+  LabeledTreeNode *x;
+  int parent;
+
+  x = q->leaf[k];
+
+  while (k>0)
+    {
+      parent = (k-1)/2;
+
+      if (!leafBetter(x,q->leaf[parent]))
+	break;
+
+      q->leaf[k] = q->leaf[parent];
+      q->leaf[k]->queuePosition = k;
+      k = parent;
+    }
+
+  q->leaf[k]       = x;
+  x->queuePosition = k;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          splitQueueDown
+//
+// function:      moves a leaf down the heap while one of its children is better
+//
+// parameters:    q............the queue
+//                k............the position of the leaf
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int splitQueueDown(SplitQueue *q, int k)
+{
+  LabeledTreeNode *x;
+  int child;
+
+  x = q->leaf[k];
+
+  while ((child=2*k+1)<q->numLeaves)
+    {
+      if ((child+1<q->numLeaves)&&(leafBetter(q->leaf[child+1],q->leaf[child])))
+	child++;
+
+      if (!leafBetter(q->leaf[child],x))
+	break;
+
+      q->leaf[k] = q->leaf[child];
+      q->leaf[k]->queuePosition = k;
+      k = child;
+    }
+
+  q->leaf[k]       = x;
+  x->queuePosition = k;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          nodeBetter
+//
+// function:      compares the best operators of two variables (the lower variable
+//                wins a tie, as it used to when they were scanned)
+//
+// parameters:    q............the queue
+//                a............the first variable
+//                b............the second variable
+//
+// returns:       (int) 1 if the first variable is better, 0 otherwise
+//
+// ================================================================================
+
+static int nodeBetter(NodeQueue *q, int a, int b)
+{
+  if (q->best[a].gain!=q->best[b].gain)
+    return (q->best[a].gain>q->best[b].gain);
+
+  return (a<b);
+}
+
+// ================================================================================
+//
+// name:          initializeNodeQueue
+//
+// function:      puts all the variables into the queue by the gains of their best
+//                operators (which must be set already)
+//
+// parameters:    q............the queue
+//                best.........the best operator of each variable
+//                n............the number of variables
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int initializeNodeQueue(NodeQueue *q, Operator *best, int n)
+{
+  int i;
+
+  q->n        = n;
+  q->best     = best;
+  q->node     = (int*) Calloc(n,sizeof(int));
+  q->position = (int*) Calloc(n,sizeof(int));
+
+  for (i=0; i<n; i++)
+    q->node[i] = q->position[i] = i;
+
+  // make it a heap
+
+  for (i=n/2-1; i>=0; i--)
+    nodeQueueDown(q,i);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          doneNodeQueue
+//
+// function:      frees the queue of variables
+//
+// parameters:    q............the queue
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int doneNodeQueue(NodeQueue *q)
+{
+  Free(q->node);
+  Free(q->position);
+
+  q->node     = NULL;
+  q->position = NULL;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          updateNodeQueue
+//
+// function:      moves a variable to its place after its best operator changed
+//
+// parameters:    q............the queue
+//                node.........the variable
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int updateNodeQueue(NodeQueue *q, int node)
+{
+  int k;
+
+  k = q->position[node];
+
+  nodeQueueUp(q,k);
+  if (q->position[node]==k)
+    nodeQueueDown(q,k);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          getBestNode
+//
+// function:      returns the variable with the best operator
+//
+// parameters:    q............the queue
+//
+// returns:       (int) the variable
+//
+// ================================================================================
+
+int getBestNode(NodeQueue *q)
+{
+  return q->node[0];
+}
+
+// ================================================================================
+//
+// name:          nodeQueueUp
+//
+// function:      moves a variable up the heap while it's better than its parent
+//
+// parameters:    q............the queue
+//                k............the position of the variable
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int nodeQueueUp(NodeQueue *q, int k)
+{
+  int node;
+  int parent;
+
+  node = q->node[k];
+
+  while (k>0)
+    {
+      parent = (k-1)/2;
+
+      if (!nodeBetter(q,node,q->node[parent]))
+	break;
+
+      q->node[k] = q->node[parent];
+      q->position[q->node[k]] = k;
+      k = parent;
+    }
+
+  q->node[k]        = node;
+  q->position[node] = k;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          nodeQueueDown
+//
+// function:      moves a variable down the heap while one of its children is better
+//
+// parameters:    q............the queue
+//                k............the position of the variable
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int nodeQueueDown(NodeQueue *q, int k)
+{
+  int node;
+  int child;
+
+  node = q->node[k];
+
+  while ((child=2*k+1)<q->n)
+    {
+      if ((child+1<q->n)&&(nodeBetter(q,q->node[child+1],q->node[child])))
+	child++;
+
+      if (!nodeBetter(q,q->node[child],node))
+	break;
+
+      q->node[k] = q->node[child];
+      q->position[q->node[k]] = k;
+      k = child;
+    }
+
+  q->node[k]        = node;
+  q->position[node] = k;
+
+  // get back
+
+  return 0;
+}
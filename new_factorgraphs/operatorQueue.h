@@ -0,0 +1,41 @@
+#ifndef _operatorQueue_h_
+#define _operatorQueue_h_
+
+#include "labeledTreeNode.h"
+#include "operator.h"
+
+// -------------------------------------------------
+// the leaves of one decision graph in a heap by the
+// gains of their best splits
+// -------------------------------------------------
+
+struct SplitQueue {
+  LabeledTreeNode **leaf;
+  int             numLeaves;
+  int             size;      // how many leaves fit in
+};
+
+// -------------------------------------------------
+// the variables in a heap by the gains of their best
+// operators
+// -------------------------------------------------
+
+struct NodeQueue {
+  int      *node;
+  int      *position;  // where in the heap each variable is
+  int      n;
+  Operator *best;      // the best operator of each variable
+};
+
+int initializeSplitQueue(SplitQueue *q);
+int doneSplitQueue(SplitQueue *q);
+int updateSplitQueue(SplitQueue *q, LabeledTreeNode *x);
+int removeFromSplitQueue(SplitQueue *q, LabeledTreeNode *x);
+LabeledTreeNode *getBestSplitLeaf(SplitQueue *q);
+
+int initializeNodeQueue(NodeQueue *q, Operator *best, int n);
+int doneNodeQueue(NodeQueue *q);
+int updateNodeQueue(NodeQueue *q, int node);
+int getBestNode(NodeQueue *q);
+
+#endif
@@ -12,19 +12,49 @@
 // ################################################################################
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "population.h"
 #include "random.h"
 #include "memalloc.h"
 #include "fitness.h"
+#include "threadPool.h"
+
+// ---------------------------------------------------------------
+// how many chunks per thread the evaluation is cut into (the more,
+// the better the load balance)
+// ---------------------------------------------------------------
+
+#define EVALUATION_CHUNKS_PER_THREAD 16
+
+// -------------------------------------------------------------------
+// the number of bits needed for the weights of a population of size N
+// -------------------------------------------------------------------
+
+static int numBitsOf(long N);
+static int compareWeights(const void *a, const void *b);
+
+// -------------------------------------------
+// a different string and its number of copies
+// -------------------------------------------
+
+typedef struct {
+  long  weight;
+  long  i;
+  char  *x;
+  float f;
+} WeightedString;
+
+static int evaluateIndividuals(long first, long last, int thread, void *data);
 
 // ================================================================================
 //
 // name:          allocatePopulation
 //
 // function:      allocates memory for a population and sets its size and string
-//                length parameters
+//                length parameters (all the strings go in one block, each on
+//                cache lines of its own)
 //
 // parameters:    population...which population to allocate memory for
 //                N............the number of strings for a population to contain
@@ -38,22 +68,76 @@ int allocatePopulation(Population *population, long N, int n)
 {
   long i;
 
-  // set the size of the population and the string length
+  // allocate everything else
 
-  population->N = N;
-  population->n = n;
+  allocatePopulationView(population,N,n);
 
   // allocate memory for strings
 
-  population->x = (char**) Calloc(N,sizeof(char*));
+  population->stride = (n+STRING_ALIGNMENT-1)&~(STRING_ALIGNMENT-1);
+  population->block  = (char*) AlignedCalloc(N,population->stride,STRING_ALIGNMENT);
   
   for (i=0; i<N; i++)
-    population->x[i] = (char*) Calloc(n,sizeof(char));
+    population->x[i] = population->block+i*population->stride;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          allocatePopulationView
+//
+// function:      allocates memory for a population that has got no strings of its
+//                own, only the pointers to the strings of another population (such
+//                as the selected parents); the strings must not be changed through
+//                the view
+//
+// parameters:    population...which population to allocate memory for
+//                N............the number of strings for a population to contain
+//                n............the length of strings
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int allocatePopulationView(Population *population, long N, int n)
+{
+  long i;
+
+  // set the size of the population and the string length
+
+  population->N = N;
+  population->n = n;
+
+  // allocate memory for the pointers to the strings
+
+  population->x      = (char**) Calloc(N,sizeof(char*));
+  population->block  = NULL;
+  population->stride = 0;
 
   // allocate memory for the array of fitness values
 
   population->f = (float*) Calloc(N,sizeof(float));
 
+  // all strings count once for now
+
+  population->numUnique = N;
+  population->weight    = (long*) Calloc(N,sizeof(long));
+
+  for (i=0; i<N; i++)
+    population->weight[i] = 1;
+
+  // the bit columns and the bits of the weights are only allocated for the
+  // populations that get packed (see packColumns)
+
+  population->numWords      = 0;
+  population->column        = NULL;
+  population->numWeightBits = 0;
+  population->weightBit     = NULL;
+  population->weightWords   = NULL;
+
   // get back
 
   return 0;
@@ -75,10 +159,10 @@ int freePopulation(Population *population)
 {
   long i;
 
-  // free the memory used by strings
+  // free the memory used by strings (a view has got none)
   
-  for (i=0; i<population->N; i++)
-    Free(population->x[i]);
+  if (population->block!=NULL)
+    Free(population->block);
 
   Free(population->x);
 
@@ -86,6 +170,26 @@ int freePopulation(Population *population)
 
   Free(population->f);
 
+  // free the memory used by the bit columns and the bits of the weights (if
+  // the population has ever been packed)
+
+  if (population->column!=NULL)
+    {
+      for (i=0; i<population->n; i++)
+	Free(population->column[i]);
+
+      for (i=0; i<numBitsOf(population->N); i++)
+	Free(population->weightBit[i]);
+
+      Free(population->column);
+      Free(population->weightBit);
+      Free(population->weightWords);
+    }
+
+  // free the weights
+
+  Free(population->weight);
+
   // get back
 
   return 0;
@@ -110,15 +214,17 @@ int generatePopulation(Population *population)
   int  j;
 	int turs=30;
 	int tur_count =0;
+	RandomStream stream;
 
-  // generate bit by bit
+  // generate bit by bit (each string from a stream of its own)
 
   for (i=0; i<population->N; i++){
+    initializeStream(&stream,RANDOM_PHASE_INITIAL,i);
     for (j=0; j<population->n; j++){
 				population->x[i][j]=0;
 		}
 		while (turs!=0){
-			int r_xy = intRand(population->n);
+			int r_xy = (int) longRandStream(&stream,population->n);
 			if (population->x[i][r_xy] == 0){
 				population->x[i][r_xy] = 1;
 				turs = turs - 1;
@@ -150,7 +256,8 @@ int generatePopulation(Population *population)
 //
 // name:          evaluatePopulation
 //
-// function:      evaluates fitness for all strings in a population
+// function:      evaluates fitness for all strings in a population (spread over
+//                the threads of the thread pool)
 //
 // parameters:    population...which population to evaluate
 //
@@ -160,12 +267,15 @@ int generatePopulation(Population *population)
 
 int evaluatePopulation(Population *population)
 {
-  long i;
+  long grain;
+
+  // cut the population into chunks
+
+  grain = population->N/(getNumThreads()*EVALUATION_CHUNKS_PER_THREAD);
 
   // evaluate each individual
 
-  for (i=0; i<population->N; i++)
-    population->f[i] = getFitnessValue(population->x[i],population->n);
+  parallelFor(population->N,grain,&evaluateIndividuals,population);
 
   // get back
 
@@ -174,52 +284,281 @@ int evaluatePopulation(Population *population)
 
 // ================================================================================
 //
-// name:          computeUnivariateFrequencies
+// name:          evaluateIndividuals
 //
-// function:      compute the frequencies of 1's on all positions in a population;
-//                does not allocate memory for them-it has to be allocated already
+// function:      evaluates fitness for a range of strings in a population
 //
-// parameters:    population...which population to compute the frequencies for
-//                p1...........the array of resulting frequencies
+// parameters:    first........the first string to evaluate
+//                last.........one past the last string to evaluate
+//                thread.......the thread running the evaluation
+//                data.........the population
 //
 // returns:       (int) 0
 //
 // ================================================================================
 
-int computeUnivariateFrequencies(Population *population, float *p1)
+static int evaluateIndividuals(long first, long last, int thread, void *data)
 {
   long i;
+  Population *population;
+
+  population = (Population*) data;
+
+  // evaluate each individual
+
+  for (i=first; i<last; i++)
+    population->f[i] = getFitnessValue(population->x[i],population->n);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          compressPopulation
+//
+// function:      moves the different strings of a population to its front (those
+//                with more copies first, otherwise in the order they first
+//                appear) and counts the copies of each, so that the frequencies
+//                can be counted on the different strings only, each with its
+//                weight; the copies stay behind them
+//
+// parameters:    population...which population to compress
+//
+// returns:       (long) the number of different strings
+//
+// ================================================================================
+
+long compressPopulation(Population *population)
+{
+  long i,j;
   int  k;
-  long *count1;
+  long numSlots;
+  long *slot;
+  uint64_t hash;
+  uint64_t *stringHash;
+  char  *auxX;
+  float auxF;
+  WeightedString *unique;
 
-  // allocate memory for the counts
-  
-  count1 = (long*) Calloc(population->n,sizeof(long));
+  // the table of the different strings (at least twice as many slots as strings)
+
+  for (numSlots=1; numSlots<2*population->N; numSlots<<=1);
+
+  slot       = (long*) Calloc(numSlots,sizeof(long));
+  stringHash = (uint64_t*) Calloc(population->N,sizeof(uint64_t));
+
+  for (j=0; j<numSlots; j++)
+    slot[j] = -1;
+
+  population->numUnique = 0;
 
-  // compute univariate counts
-  
-  for (k=0; k<population->n; k++)
-    count1[k]=0;
-  
   for (i=0; i<population->N; i++)
-    for (k=0; k<population->n; k++)
-      if (population->x[i][k])
-	count1[k]++;
-  
-  // compute the frequencies
+    {
+      // hash the string (FNV-1a)
+
+      hash = 14695981039346656037ULL;
+      for (k=0; k<population->n; k++)
+	{
+	  hash ^= (unsigned char) population->x[i][k];
+	  hash *= 1099511628211ULL;
+	}
+
+      // look it up
+
+      for (j=hash&(numSlots-1); slot[j]>=0; j=(j+1)&(numSlots-1))
+	if ((stringHash[slot[j]]==hash)&&(!memcmp(population->x[slot[j]],population->x[i],population->n)))
+	  break;
+
+      if (slot[j]>=0)
+	population->weight[slot[j]]++;
+      else
+	{
+	  // a new one, move it behind those we've got (a copy goes where it was)
+
+	  auxX = population->x[i];
+	  auxF = population->f[i];
+	  population->x[i] = population->x[population->numUnique];
+	  population->f[i] = population->f[population->numUnique];
+	  population->x[population->numUnique] = auxX;
+	  population->f[population->numUnique] = auxF;
+
+	  stringHash[population->numUnique] = hash;
+	  population->weight[population->numUnique] = 1;
+	  slot[j] = population->numUnique++;
+	}
+    }
+
+  Free(slot);
+  Free(stringHash);
+
+  // those with more copies go first (so that the high bits of the weights
+  // are all in the first words of the columns)
+
+  unique = (WeightedString*) Calloc(population->numUnique,sizeof(WeightedString));
+
+  for (i=0; i<population->numUnique; i++)
+    {
+      unique[i].weight = population->weight[i];
+      unique[i].i      = i;
+      unique[i].x      = population->x[i];
+      unique[i].f      = population->f[i];
+    }
+
+  qsort(unique,population->numUnique,sizeof(WeightedString),&compareWeights);
+
+  for (i=0; i<population->numUnique; i++)
+    {
+      population->weight[i] = unique[i].weight;
+      population->x[i]      = unique[i].x;
+      population->f[i]      = unique[i].f;
+    }
+
+  Free(unique);
+
+  // get back
+
+  return population->numUnique;
+}
+
+// ================================================================================
+//
+// name:          packColumns
+//
+// function:      packs the different strings of a population (see
+//                compressPopulation) into bit columns, one for each position, so
+//                that the strings with a particular combination of values can be
+//                counted 64 at a time; their weights are packed bit by bit the
+//                same way, unless they're all 1 (the columns are allocated the
+//                first time the population is packed, big enough for all its
+//                strings)
+//
+// parameters:    population...which population to pack
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int packColumns(Population *population)
+{
+  long i;
+  int  k,b;
+  long maxWeight;
+  uint64_t bit;
+  uint64_t **column;
+  long maxWords;
+
+  // allocate the columns and the bits of the weights the first time
+
+  if (population->column==NULL)
+    {
+      maxWords = (population->N+63)/64;
+
+      population->column      = (uint64_t**) Calloc(population->n,sizeof(uint64_t*));
+      population->weightBit   = (uint64_t**) Calloc(numBitsOf(population->N),sizeof(uint64_t*));
+      population->weightWords = (long*) Calloc(numBitsOf(population->N),sizeof(long));
+
+      for (k=0; k<population->n; k++)
+	population->column[k] = (uint64_t*) Calloc(maxWords,sizeof(uint64_t));
+
+      for (b=0; b<numBitsOf(population->N); b++)
+	population->weightBit[b] = (uint64_t*) Calloc(maxWords,sizeof(uint64_t));
+    }
+
+  column = population->column;
+
+  population->numWords = (population->numUnique+63)/64;
 
   for (k=0; k<population->n; k++)
-    p1[k]=(float) count1[k]/(float) population->N;
+    memset(column[k],0,population->numWords*sizeof(uint64_t));
+
+  for (i=0; i<population->numUnique; i++)
+    {
+      bit = ((uint64_t) 1)<<(i&63);
+
+      for (k=0; k<population->n; k++)
+	if (population->x[i][k])
+	  column[k][i>>6] |= bit;
+    }
+
+  // the bits of the weights (none if they're all 1)
 
-  // free the memory used by the counts
+  maxWeight = 1;
+  for (i=0; i<population->numUnique; i++)
+    if (population->weight[i]>maxWeight)
+      maxWeight = population->weight[i];
 
-  Free(count1);
+  population->numWeightBits = (maxWeight>1)? numBitsOf(maxWeight):0;
+
+  for (b=0; b<population->numWeightBits; b++)
+    {
+      memset(population->weightBit[b],0,population->numWords*sizeof(uint64_t));
+
+      for (i=0; i<population->numUnique; i++)
+	if ((population->weight[i]>>b)&1)
+	  population->weightBit[b][i>>6] |= ((uint64_t) 1)<<(i&63);
+
+      // the weights go down, so the high bits are all in the first words
+
+      for (i=0; (i<population->numUnique)&&(population->weight[i]>=(1L<<b)); i++);
+      population->weightWords[b] = (i+63)/64;
+    }
 
   // get back
 
   return 0;
 }
 
+// ================================================================================
+//
+// name:          compareWeights
+//
+// function:      compares two different strings for qsort (the one with more
+//                copies goes first, the one that came first if they've got the
+//                same number)
+//
+// parameters:    a............the first string
+//                b............the second string
+//
+// returns:       (int) negative if a goes first, positive if b does
+//
+// ================================================================================
+
+static int compareWeights(const void *a, const void *b)
+{
+  const WeightedString *x,*y;
+
+  x = (const WeightedString*) a;
+  y = (const WeightedString*) b;
+
+  if (x->weight!=y->weight)
+    return (x->weight>y->weight)? -1:1;
+
+  return (x->i<y->i)? -1:1;
+}
+
+// ================================================================================
+//
+// name:          numBitsOf
+//
+// function:      returns the number of bits needed to write down a number
+//
+// parameters:    N............the number
+//
+// returns:       (int) the number of bits
+//
+// ================================================================================
+
+static int numBitsOf(long N)
+{
+  int numBits;
+
+  for (numBits=1; (N>>numBits)>0; numBits++);
+
+  return numBits;
+}
+
 // ================================================================================
 //
 // name:          copyIndividual
@@ -269,15 +608,11 @@ int swapIndividuals(Population *population, long first, long second)
   char *auxX;
   float auxF;
 
-  // allocate memory for an auxilary string
-
-  auxX = (char*) Malloc(population->n);
-  
-  // swap the strings
+  // swap the strings (only the pointers, they stay in the block)
 
-  memcpy(auxX,population->x[first],population->n);
-  memcpy(population->x[first],population->x[second],population->n);
-  memcpy(population->x[second],auxX,population->n);
+  auxX = population->x[first];
+  population->x[first] = population->x[second];
+  population->x[second] = auxX;
   
   // swap the fitness values
 
@@ -285,10 +620,6 @@ int swapIndividuals(Population *population, long first, long second)
   population->f[first] = population->f[second];
   population->f[second] = auxF; 
 
-  // free the memory used by an auxilary string
-
-  Free(auxX);
-
   // get back
 
   return 0;
@@ -2,6 +2,9 @@
 #define _population_h_
 
 #include <stdio.h>
+#include <stdint.h>
+
+#define STRING_ALIGNMENT 64
 
 typedef struct {
 
@@ -11,14 +14,35 @@ typedef struct {
   char  **x;      // strings
   float *f;       // fitness values
 
+  char  *block;   // the strings one after another, stride bytes apart (NULL for
+                  // a view, the strings of which are those of another population)
+  long  stride;   // the length of the strings rounded up to whole cache lines
+
+  long  numUnique;   // the first numUnique strings are all different and the
+                     // rest are their copies (see compressPopulation)
+  long  *weight;     // the number of copies of each of the first numUnique strings
+                     // (those with more copies go first)
+
+  uint64_t **column; // bit k of string i in bit i%64 of column[k][i/64] (allocated
+                     // and filled in by packColumns for the first numUnique strings,
+                     // NULL until then, not kept up to date with x)
+  long  numWords;    // 64-bit words per column in use
+  uint64_t **weightBit; // bit b of weight[i] in bit i%64 of weightBit[b][i/64] (allocated
+                        // and filled in by packColumns)
+  long  *weightWords;   // the words of weightBit[b] in use (the strings with 2^b or
+                        // more copies are in the first ones)
+  int   numWeightBits;  // the number of bits of the weights (0 if they're all 1)
+
 } Population;
 
 int allocatePopulation(Population *population, long N, int n);
+int allocatePopulationView(Population *population, long N, int n);
 int freePopulation(Population *population);
 int generatePopulation(Population *population);
 int evaluatePopulation(Population *population);
 
-int computeUnivariateFrequencies(Population *population, float *p1);
+long compressPopulation(Population *population);
+int packColumns(Population *population);
 
 int copyIndividual(Population *population, long where, char *x, float f);
 int swapIndividuals(Population *population, long first, long second);
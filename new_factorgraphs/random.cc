@@ -4,9 +4,11 @@
 //
 // author:        Martin Pelikan
 //
-// purpose:       random number generator related functions (random generator is 
-//                based on the code by Fernando Lobo, Prime Modulus Multiplicative 
-//                Linear Congruential Generator (PMMLCG)
+// purpose:       random number generator related functions (the generator is the
+//                counter-based Philox4x32-10, so that every task can have a stream
+//                of its own given by the seed, the generation, the phase of the
+//                generation and the number of the task, and the results don't
+//                depend on which thread does what)
 //
 // last modified: August 2000
 //
@@ -17,18 +19,227 @@
 
 #include "random.h"
 
-long _Q = _M/_A;     // M / A 
-long _R = _M%_A;     // M mod A
-long _seed;          // a number between 1 and m-1
+// ------------------------------------
+// the constants of Philox4x32
+// ------------------------------------
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+#define PHILOX_ROUNDS 10
+
+// ------------------------------------
+// 2^-32 (turns 32 bits into [0,1))
+// ------------------------------------
+
+#define TWO_TO_MINUS_32 (1.0/4294967296.0)
+
+long _seed;               // the seed of the run
+long _generation;         // the current generation
+
+RandomStream mainStream;  // the stream of drand and the rest
 
 char whichGaussian=0; // which gaussian to generate
 
+static inline void philox(const uint32_t *counter, const uint32_t *key, uint32_t *out);
+static inline void nextBlock(RandomStream *stream);
+
+// ================================================================================
+//
+// name:          philox
+//
+// function:      the Philox4x32-10 function (four random words for a counter
+//                and a key)
+//
+// parameters:    counter......the counter (4 words)
+//                key..........the key (2 words)
+//                out..........the random words (4 words, output)
+//
+// returns:       (void)
+//
+// ================================================================================
+
+static inline void philox(const uint32_t *counter, const uint32_t *key, uint32_t *out)
+{
+  uint32_t c0,c1,c2,c3;
+  uint32_t k0,k1;
+  uint64_t p0,p1;
+  int r;
+
+  c0 = counter[0];
+  c1 = counter[1];
+  c2 = counter[2];
+  c3 = counter[3];
+  k0 = key[0];
+  k1 = key[1];
+
+  for (r=0; r<PHILOX_ROUNDS; r++)
+    {
+      p0 = (uint64_t) PHILOX_M0*c0;
+      p1 = (uint64_t) PHILOX_M1*c2;
+
+      c0 = (uint32_t) (p1>>32)^c1^k0;
+      c2 = (uint32_t) (p0>>32)^c3^k1;
+      c1 = (uint32_t) p1;
+      c3 = (uint32_t) p0;
+
+      k0 += PHILOX_W0;
+      k1 += PHILOX_W1;
+    }
+
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+// ================================================================================
+//
+// name:          nextBlock
+//
+// function:      generates the next four words of a stream
+//
+// parameters:    stream.......the stream
+//
+// returns:       (void)
+//
+// ================================================================================
+
+static inline void nextBlock(RandomStream *stream)
+{
+  philox(stream->counter,stream->key,stream->buffer);
+
+  stream->counter[0]++;
+  stream->used = 0;
+}
+
+// ================================================================================
+//
+// name:          initializeStream
+//
+// function:      starts the stream of a task (given by the seed of the run, the
+//                current generation, the phase and the number of the task)
+//
+// parameters:    stream.......the stream
+//                phase........the phase of the generation (RANDOM_PHASE_...)
+//                index........the number of the task in the phase
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int initializeStream(RandomStream *stream, int phase, long index)
+{
+  stream->key[0]     = (uint32_t) _seed;
+  stream->key[1]     = (uint32_t) (((uint64_t) _seed)>>32);
+  stream->counter[0] = 0;
+  stream->counter[1] = (uint32_t) index;
+  stream->counter[2] = (uint32_t) _generation;
+  stream->counter[3] = (((uint32_t) phase)<<24)^((uint32_t) (((uint64_t) index)>>32));
+  stream->used       = 4;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          drandStream
+//
+// function:      returns a random number from [0,1) from a stream
+//
+// parameters:    stream.......the stream
+//
+// returns:       (double) resulting random number
+//
+// ================================================================================
+
+double drandStream(RandomStream *stream)
+{
+  if (stream->used==4)
+    nextBlock(stream);
+
+  return stream->buffer[stream->used++]*TWO_TO_MINUS_32;
+}
+
+// ================================================================================
+//
+// name:          longRandStream
+//
+// function:      returns a long integer random from [0,max) from a stream
+//
+// parameters:    stream.......the stream
+//                max..........the upper bound
+//
+// returns:       (long) resulting random number
+//
+// ================================================================================
+
+long longRandStream(RandomStream *stream, long max)
+{
+  return (long) (drandStream(stream)*(double) max);
+}
+
+// ================================================================================
+//
+// name:          fillUniform
+//
+// function:      fills an array with random numbers from [0,1) from a stream (the
+//                same numbers drandStream would return one after another, only the
+//                whole blocks are generated straight into the array)
+//
+// parameters:    stream.......the stream
+//                u............the array (output)
+//                count........how many numbers to generate
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int fillUniform(RandomStream *stream, double *u, long count)
+{
+  long i;
+  uint32_t out[4];
+
+  // use up what's left of the current block
+
+  i = 0;
+  while ((i<count)&&(stream->used<4))
+    u[i++] = stream->buffer[stream->used++]*TWO_TO_MINUS_32;
+
+  // the whole blocks
+
+  for (; i+4<=count; i+=4)
+    {
+      philox(stream->counter,stream->key,out);
+      stream->counter[0]++;
+
+      u[i]   = out[0]*TWO_TO_MINUS_32;
+      u[i+1] = out[1]*TWO_TO_MINUS_32;
+      u[i+2] = out[2]*TWO_TO_MINUS_32;
+      u[i+3] = out[3]*TWO_TO_MINUS_32;
+    }
+
+  // and the rest from a new block
+
+  while (i<count)
+    u[i++] = drandStream(stream);
+
+  // get back
+
+  return 0;
+}
+
 // ================================================================================
 //
 // name:          drand
 //
 // function:      returns a floating-point random number generated according to
-//                uniform distribution from [0,1)
+//                uniform distribution from [0,1) (from the main stream, for what
+//                is done serially)
 //
 // parameters:    (none)
 //
@@ -38,18 +249,7 @@ char whichGaussian=0; // which gaussian to generate
 
 double drand()
 {
-  long lo,hi,test;
-  
-  hi   = _seed / _Q;
-  lo   = _seed % _Q;
-  test = _A*lo - _R*hi;
-  
-  if (test>0)
-    _seed = test;
-  else
-    _seed = test+_M;
-
-  return double(_seed)/_M;
+  return drandStream(&mainStream);
 }
 
 // ================================================================================
@@ -110,7 +310,7 @@ char flipCoin()
 //
 // name:          setSeed
 //
-// function:      sets the random seed
+// function:      sets the random seed (and restarts the main stream)
 //
 // parameters:    seed.........a new random seed
 //
@@ -120,7 +320,29 @@ char flipCoin()
 
 long  setSeed(long newSeed)
 {
-  // set the seed and return the result of the operation
-  
-  return (_seed = newSeed);
+  _seed       = newSeed;
+  _generation = 0;
+
+  initializeStream(&mainStream,RANDOM_PHASE_MAIN,0);
+
+  // get back
+
+  return _seed;
+}
+
+// ================================================================================
+//
+// name:          setRandomGeneration
+//
+// function:      sets the generation the streams started from now on belong to
+//
+// parameters:    generation...the generation
+//
+// returns:       (long) the generation
+//
+// ================================================================================
+
+long setRandomGeneration(long generation)
+{
+  return (_generation = generation);
 }
@@ -1,8 +1,29 @@
 #ifndef _random_h_
 #define _random_h_
 
-#define _M 2147483647     // modulus of PMMLCG (the default is 2147483647 = 2^31 - 1)
-#define _A 16807          // the default is 16807
+#include <stdint.h>
+
+// -------------------------------------------------------------------
+// the phases of a generation (each phase has got streams of its own)
+// -------------------------------------------------------------------
+
+#define RANDOM_PHASE_MAIN        0
+#define RANDOM_PHASE_INITIAL     1
+#define RANDOM_PHASE_SELECTION   2
+#define RANDOM_PHASE_SAMPLING    3
+#define RANDOM_PHASE_REPLACEMENT 4
+
+// -------------------------------------------------------------------
+// a stream of random numbers (the counter-based generator needs only
+// the key and the counter, the buffer keeps the unused words)
+// -------------------------------------------------------------------
+
+typedef struct {
+  uint32_t key[2];
+  uint32_t counter[4];
+  uint32_t buffer[4];
+  int      used;        // how many words of the buffer have been used
+} RandomStream;
 
 double drand();
 int intRand(int max);
@@ -11,5 +32,11 @@ char flipCoin();
 double gaussianRandom(double mean,double stddev);
 
 long setSeed(long newSeed);
+long setRandomGeneration(long generation);
+
+int initializeStream(RandomStream *stream, int phase, long index);
+double drandStream(RandomStream *stream);
+long longRandStream(RandomStream *stream, long max);
+int fillUniform(RandomStream *stream, double *u, long count);
 
 #endif
@@ -5,121 +5,284 @@
 // author:        Martin Pelikan
 //
 // purpose:       the definition of replacement replacing the worst portion of the
-//                original population and the divide and conquer function it uses
-//                to separate the worst
+//                original population (the worst are read off the fitness order
+//                the running statistics keep, the ties are broken at random, and
+//                the best offspring are copied into the slots of the replaced
+//                guys)
 //
 // last modified: August 2000
 //
 // ################################################################################
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "population.h"
 #include "replace.h"
 #include "random.h"
+#include "memalloc.h"
+#include "threadPool.h"
+
+// ---------------------------------------------------------------------
+// how many chunks per thread the copying of the offspring is cut into
+// ---------------------------------------------------------------------
+
+#define REPLACEMENT_CHUNKS_PER_THREAD 4
+
+// ---------------------------------------------------------------------
+// the offspring put into their slots by the threads
+// ---------------------------------------------------------------------
+
+typedef struct {
+  Population *population;
+  Population *offspring;
+  long       *slot;       // where each of the offspring goes
+} ReplacementTask;
+
+// ---------------------------------------------------------------------
+// an offspring and its fitness (for ordering the offspring by fitness)
+// ---------------------------------------------------------------------
+
+typedef struct {
+  float f;
+  long  index;
+} RankedOffspring;
+
+static int moveBestToFront(Population *offspring);
+static int compareOffspring(const void *a, const void *b);
+static int copyIndividuals(long first, long last, int thread, void *data);
 
 // ================================================================================
 //
-// name:          replaceTheWorst
+// name:          replaceWorst
 //
-// function:      performs the opposite to a truncation selection for replacement 
-//                (replacing the worst guys from the population by the offspring)
+// function:      performs the opposite to a truncation selection for replacement
+//                (replacing the worst guys from the population by the offspring);
+//                the guys of the same fitness as the best replaced one are
+//                replaced at random, the elite are never replaced and at most the
+//                quota of the population is; the offspring are copied over the
+//                replaced guys (so the strings of the population stay in its
+//                block), and if not all of them fit in, the worst ones are
+//                dropped
 //
 // parameters:    population...the population where to put the offspring
-//                parents......the offspring population
+//                offspring....the offspring population
+//                running......the statistics of the population (its fitness
+//                             order, updated here)
+//                params.......the parameters passed to the BOA
 //
 // returns:       (int) 0
 //
 // ================================================================================
 
-int replaceWorst(Population *population, Population *offspring)
+int replaceWorst(Population *population, Population *offspring, RunningStatistics *running, BoaParams *params)
 {
-  long i,j;
-  long M,N,NM;
-  int n;
+  long M,N;
+  long j,k;
+  long numElite,maxReplaced;
+  long numWorse,numTies;
+  long aux;
+  long grain;
+  long *tie;
+  float thresholdF;
+  RandomStream stream;
+  ReplacementTask task;
 
   // initialize variables
 
-  N  = population->N;
-  M  = offspring->N;
-  n  = population->n;
+  N = population->N;
+  M = offspring->N;
+
+  // keep the elite and stick to the quota
+
+  numElite    = (long) ((float) N*params->percentElite)/100;
+  maxReplaced = (long) ((float) N*params->maxReplacedPercent)/100;
+
+  if (M>N-numElite)
+    M = N-numElite;
+  if (M>maxReplaced)
+    M = maxReplaced;
+
+  if (M<=0)
+    return 0;
+
+  // only the best M offspring make it in (put them first)
+
+  if (M<offspring->N)
+    moveBestToFront(offspring);
+
+  task.population = population;
+  task.offspring  = offspring;
+  task.slot       = (long*) Calloc(M,sizeof(long));
+
+  // all those worse than the best of the worst M go
 
-  NM = N-M;
+  thresholdF = running->f[getRankedIndividual(running,M-1)];
+  numWorse   = countWorseThan(running,thresholdF);
+  numTies    = countNotBetterThan(running,thresholdF)-numWorse;
 
-  // shuffle the individuals a little
+  listRankedIndividuals(running,0,numWorse,task.slot);
 
-  for (i=0; i<N; i++)
+  // and the rest are picked at random from those as good as it
+
+  tie = (long*) Calloc(numTies,sizeof(long));
+  listRankedIndividuals(running,numWorse,numTies,tie);
+
+  initializeStream(&stream,RANDOM_PHASE_REPLACEMENT,0);
+
+  for (j=0; j<M-numWorse; j++)
     {
-      j = (long) ((double)drand()*(double)N);
+      k = j+longRandStream(&stream,numTies-j);
+
+      aux    = tie[j];
+      tie[j] = tie[k];
+      tie[k] = aux;
+
+      task.slot[numWorse+j] = tie[j];
+    }
+
+  Free(tie);
+
+  // the statistics change only as much as the replaced guys (they are
+  // gone once the offspring are in)
+
+  updateRunningStatistics(running,population,offspring,task.slot,M);
+
+  // put the offspring in the slots
 
-      if (i!=j)
-	swapIndividuals(population,i,j);
-    };
+  grain = M/(getNumThreads()*REPLACEMENT_CHUNKS_PER_THREAD);
+  parallelFor(M,grain,&copyIndividuals,&task);
 
-  // separate worst M individuals by divide and conquer 
+  // free the memory
 
-  divideWorst(population,0,N-1,n,N-M);
+  Free(task.slot);
 
-  // replace the worst M
+  // get back
 
-  for (i=NM; i<N; i++)
-    copyIndividual(population,i,offspring->x[i-NM],offspring->f[i-NM]);
-  
   return 0;
 }
 
 // ================================================================================
 //
-// name:          divideWorst
+// name:          moveBestToFront
 //
-// function:      do divide-and-conquer until the last M individuals (individuals
-//                [NM...N]) are worse or equal than the rest (of totally N
-//                individuals)
+// function:      orders the offspring by their fitness, the best first (those of
+//                the same fitness keep their order, so the result doesn't
+//                depend on the number of threads); only the pointers to the
+//                strings are moved
 //
-// parameters:    population...the population from which to separate the worst M
-//                left.........a pointer pointing to the left-most individual of
-//                             the currently processed part of the population
-//                right........a pointer pointing to the right-most individual of
-//                             the currently processed part of the population
-//                NM...........size of the population minus the number of 
-//                             individuals to separate (N-M)
+// parameters:    offspring....the offspring to order
 //
 // returns:       (int) 0
 //
 // ================================================================================
 
-int divideWorst(Population *population, long left, long right, int n, long NM)
+static int moveBestToFront(Population *offspring)
 {
-  long l,r;
-  float pivot;
+  long j,N;
+  RankedOffspring *ranked;
+  char **x;
 
-  l  = left;
-  r  = right;
+  N = offspring->N;
 
-  pivot = (population->f[l]+population->f[r])/2;
+  // sort the offspring by fitness
 
-  while (l<=r)
+  ranked = (RankedOffspring*) Calloc(N,sizeof(RankedOffspring));
+
+  for (j=0; j<N; j++)
     {
-      while ((l<right)&&(population->f[l]>pivot)) l++;
-      while ((r>left)&&(population->f[r]<pivot)) r--;
+      ranked[j].f     = offspring->f[j];
+      ranked[j].index = j;
+    }
 
-      if (l<=r)
-	{
-	  if (l!=r)
-	    swapIndividuals(population,l,r);
+  qsort(ranked,N,sizeof(RankedOffspring),&compareOffspring);
 
-	  l++;
-	  r--;
-	}
-    };
+  // and put them in that order
 
-  if ((l==NM)||(r==(NM-1)))
-    return 0;
-  
-  if ((r>=NM)&&(left<r))
-    divideWorst(population,left,r,n,NM);
+  x = (char**) Calloc(N,sizeof(char*));
+
+  for (j=0; j<N; j++)
+    x[j] = offspring->x[ranked[j].index];
+
+  for (j=0; j<N; j++)
+    {
+      offspring->x[j] = x[j];
+      offspring->f[j] = ranked[j].f;
+    }
+
+  // free the memory
+
+  Free(x);
+  Free(ranked);
+
+  // get back
 
-  if ((l<NM)&&(l<right))
-    divideWorst(population,l,right,n,NM);
-  
   return 0;
 }
 
+// ================================================================================
+//
+// name:          compareOffspring
+//
+// function:      compares two offspring for qsort (the better one goes first, the
+//                one with the lower index if they are as good)
+//
+// parameters:    a............the first offspring
+//                b............the second offspring
+//
+// returns:       (int) negative if a goes first, positive if b does
+//
+// ================================================================================
+
+static int compareOffspring(const void *a, const void *b)
+{
+  const RankedOffspring *x,*y;
+
+  x = (const RankedOffspring*) a;
+  y = (const RankedOffspring*) b;
+
+  if (x->f!=y->f)
+    return (x->f>y->f)? -1:1;
+
+  if (x->index!=y->index)
+    return (x->index<y->index)? -1:1;
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          copyIndividuals
+//
+// function:      copies the offspring first...last-1 and their fitness into
+//                their slots
+//
+// parameters:    first........the first offspring
+//                last.........one past the last offspring
+//                thread.......the thread running the task (unused)
+//                data.........the task (ReplacementTask)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int copyIndividuals(long first, long last, int thread, void *data)
+{
+  long j;
+  long i;
+  ReplacementTask *task;
+
+  task = (ReplacementTask*) data;
+
+  for (j=first; j<last; j++)
+    {
+      i = task->slot[j];
+
+      memcpy(task->population->x[i],task->offspring->x[j],task->population->n);
+      task->population->f[i] = task->offspring->f[j];
+    }
+
+  // get back
+
+  return 0;
+}
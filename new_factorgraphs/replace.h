@@ -1,8 +1,10 @@
 #ifndef _replace_h_
 #define _replace_h_
 
-int replaceWorst(Population *population, Population *offspring);
+#include "population.h"
+#include "runningStatistics.h"
+#include "boa.h"
 
-int divideWorst(Population *population, long left, long right, int n, long M);
+int replaceWorst(Population *population, Population *offspring, RunningStatistics *running, BoaParams *params);
 
 #endif
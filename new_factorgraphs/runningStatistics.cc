@@ -0,0 +1,760 @@
+// ################################################################################
+//
+// name:          runningStatistics.cc
+//
+// purpose:       the statistics of the population kept up to date by the changes
+//                the replacement makes (so that they cost only as much as the
+//                replaced strings do, not the whole population); the fitness
+//                values are kept in a treap ordered by the fitness (and then by
+//                the position, the earlier string of the same fitness is better)
+//
+// ################################################################################
+
+#include <string.h>
+#include <math.h>
+
+#include "runningStatistics.h"
+#include "fitness.h"
+#include "memalloc.h"
+#include "threadPool.h"
+
+// ---------------------------------------------------------------
+// how many chunks per thread the counting is cut into
+// ---------------------------------------------------------------
+
+#define RUNNING_CHUNKS_PER_THREAD 4
+
+// ---------------------------------------------------------------
+// the counting done by the threads (the strings j of added are to
+// replace the strings slot[j] of replaced; with nothing replaced, the
+// strings j of added are counted)
+// ---------------------------------------------------------------
+
+typedef struct {
+  RunningStatistics *running;
+  Population        *added;
+  Population        *replaced;
+  long              *slot;
+} RunningTask;
+
+static int countChanges(long first, long last, int thread, void *data);
+static int addChanges(RunningStatistics *running, Population *added, Population *replaced, long *slot, long M);
+
+static long listNodes(RunningStatistics *running, long x, long first, long count, long *individual);
+
+static int nodeBefore(RunningStatistics *running, long a, long b);
+static int updateSize(RunningStatistics *running, long x);
+static long insertNode(RunningStatistics *running, long root, long x);
+static long removeNode(RunningStatistics *running, long root, long x);
+static long mergeNodes(RunningStatistics *running, long a, long b);
+
+// ================================================================================
+//
+// name:          initializeRunningStatistics
+//
+// function:      allocates the statistics and computes them for a population (the
+//                only time the whole population is gone through)
+//
+// parameters:    running......the statistics
+//                population...the population
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int initializeRunningStatistics(RunningStatistics *running, Population *population)
+{
+  long i;
+  uint64_t h;
+
+  running->N = population->N;
+  running->n = population->n;
+
+  running->count1       = (long*) Calloc(running->n,sizeof(long));
+  running->f            = (float*) Calloc(running->N,sizeof(float));
+  running->left         = (long*) Calloc(running->N,sizeof(long));
+  running->right        = (long*) Calloc(running->N,sizeof(long));
+  running->size         = (long*) Calloc(running->N,sizeof(long));
+  running->priority     = (uint32_t*) Calloc(running->N,sizeof(uint32_t));
+  running->delta        = (long*) Calloc((long) getNumThreads()*running->n,sizeof(long));
+  running->deltaOptimal = (long*) Calloc(getNumThreads(),sizeof(long));
+
+  // count the 1's and the optima
+
+  running->numOptimal = 0;
+
+  addChanges(running,population,NULL,NULL,population->N);
+
+  // the sum of the fitness values and the tree (the priorities are a hash of
+  // the position, so the tree doesn't use the random generator)
+
+  running->sumF = 0;
+  running->root = -1;
+
+  for (i=0; i<running->N; i++)
+    {
+      h  = (uint64_t) (i+1)*0x9E3779B97F4A7C15ull;
+      h ^= h>>29;
+      h *= 0xBF58476D1CE4E5B9ull;
+      h ^= h>>32;
+
+      running->f[i]        = population->f[i];
+      running->priority[i] = (uint32_t) h;
+      running->sumF       += population->f[i];
+      running->root        = insertNode(running,running->root,i);
+    }
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          doneRunningStatistics
+//
+// function:      frees the memory used by the statistics
+//
+// parameters:    running......the statistics
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int doneRunningStatistics(RunningStatistics *running)
+{
+  Free(running->count1);
+  Free(running->f);
+  Free(running->left);
+  Free(running->right);
+  Free(running->size);
+  Free(running->priority);
+  Free(running->delta);
+  Free(running->deltaOptimal);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          updateRunningStatistics
+//
+// function:      updates the statistics for the offspring that are to replace
+//                the strings in the slots of the population (before they are
+//                put there)
+//
+// parameters:    running......the statistics
+//                population...the population (before the replacement)
+//                offspring....the offspring and their fitness values
+//                slot.........where in the population each of them goes
+//                M............the number of the replaced strings
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int updateRunningStatistics(RunningStatistics *running,
+			    Population *population,
+			    Population *offspring,
+			    long *slot,
+			    long M)
+{
+  long j,i;
+
+  // the counts of 1's and the optima
+
+  addChanges(running,offspring,population,slot,M);
+
+  // the fitness values
+
+  for (j=0; j<M; j++)
+    {
+      i = slot[j];
+
+      running->sumF += (double) offspring->f[j]-(double) population->f[i];
+
+      running->root = removeNode(running,running->root,i);
+      running->f[i] = offspring->f[j];
+      running->root = insertNode(running,running->root,i);
+    }
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          getWorstIndividual
+//
+// function:      returns the string with the lowest fitness
+//
+// parameters:    running......the statistics
+//
+// returns:       (long) its position in the population
+//
+// ================================================================================
+
+long getWorstIndividual(RunningStatistics *running)
+{
+  long x;
+
+  for (x=running->root; running->left[x]>=0; x=running->left[x]);
+
+  return x;
+}
+
+// ================================================================================
+//
+// name:          getBestIndividual
+//
+// function:      returns the string with the highest fitness (the first one of
+//                those with the same fitness)
+//
+// parameters:    running......the statistics
+//
+// returns:       (long) its position in the population
+//
+// ================================================================================
+
+long getBestIndividual(RunningStatistics *running)
+{
+  long x;
+
+  for (x=running->root; running->right[x]>=0; x=running->right[x]);
+
+  return x;
+}
+
+// ================================================================================
+//
+// name:          getRankedIndividual
+//
+// function:      returns the string of a given rank by fitness (0 is the worst,
+//                N-1 the best)
+//
+// parameters:    running......the statistics
+//                rank.........the rank
+//
+// returns:       (long) its position in the population
+//
+// ================================================================================
+
+long getRankedIndividual(RunningStatistics *running, long rank)
+{
+  long x;
+  long leftSize;
+
+  x = running->root;
+
+  while (x>=0)
+    {
+      leftSize = (running->left[x]>=0)? running->size[running->left[x]]:0;
+
+      if (rank<leftSize)
+	x = running->left[x];
+      else
+	if (rank==leftSize)
+	  return x;
+	else
+	  {
+	    rank -= leftSize+1;
+	    x     = running->right[x];
+	  }
+    }
+
+  return -1;
+}
+
+// ================================================================================
+//
+// name:          listRankedIndividuals
+//
+// function:      lists the strings of the ranks first...first+count-1 by fitness
+//                (from the worse to the better ones)
+//
+// parameters:    running......the statistics
+//                first........the first rank
+//                count........the number of the strings to list
+//                individual...the positions of the strings (output)
+//
+// returns:       (long) the number of the listed strings
+//
+// ================================================================================
+
+long listRankedIndividuals(RunningStatistics *running, long first, long count, long *individual)
+{
+  if ((count<=0)||(running->root<0))
+    return 0;
+
+  return listNodes(running,running->root,first,count,individual);
+}
+
+// ================================================================================
+//
+// name:          countWorseThan
+//
+// function:      counts the strings with fitness below a value
+//
+// parameters:    running......the statistics
+//                f............the value
+//
+// returns:       (long) the number of the strings
+//
+// ================================================================================
+
+long countWorseThan(RunningStatistics *running, float f)
+{
+  long x;
+  long count;
+
+  count = 0;
+
+  for (x=running->root; x>=0;)
+    if (running->f[x]<f)
+      {
+	count += 1+((running->left[x]>=0)? running->size[running->left[x]]:0);
+	x      = running->right[x];
+      }
+    else
+      x = running->left[x];
+
+  return count;
+}
+
+// ================================================================================
+//
+// name:          countNotBetterThan
+//
+// function:      counts the strings with fitness below or equal to a value
+//
+// parameters:    running......the statistics
+//                f............the value
+//
+// returns:       (long) the number of the strings
+//
+// ================================================================================
+
+long countNotBetterThan(RunningStatistics *running, float f)
+{
+  long x;
+  long count;
+
+  count = 0;
+
+  for (x=running->root; x>=0;)
+    if (running->f[x]<=f)
+      {
+	count += 1+((running->left[x]>=0)? running->size[running->left[x]]:0);
+	x      = running->right[x];
+      }
+    else
+      x = running->left[x];
+
+  return count;
+}
+
+// ================================================================================
+//
+// name:          getBitEntropy
+//
+// function:      returns the entropy of a position (in bits)
+//
+// parameters:    running......the statistics
+//                k............the position
+//
+// returns:       (double) the entropy
+//
+// ================================================================================
+
+double getBitEntropy(RunningStatistics *running, int k)
+{
+  double p1;
+
+  p1 = (double) running->count1[k]/(double) running->N;
+
+  if ((p1<=0)||(p1>=1))
+    return 0;
+
+  return -(p1*log(p1)+(1-p1)*log(1-p1))/log(2.0);
+}
+
+// ================================================================================
+//
+// name:          getPopulationEntropy
+//
+// function:      returns the average entropy of the positions
+//
+// parameters:    running......the statistics
+//
+// returns:       (double) the entropy
+//
+// ================================================================================
+
+double getPopulationEntropy(RunningStatistics *running)
+{
+  int k;
+  double entropy;
+
+  entropy = 0;
+  for (k=0; k<running->n; k++)
+    entropy += getBitEntropy(running,k);
+
+  return entropy/running->n;
+}
+
+// ================================================================================
+//
+// name:          getPopulationDiversity
+//
+// function:      returns the average Hamming distance of two different strings
+//                of the population
+//
+// parameters:    running......the statistics
+//
+// returns:       (double) the distance
+//
+// ================================================================================
+
+double getPopulationDiversity(RunningStatistics *running)
+{
+  int k;
+  double N;
+  double distance;
+
+  if (running->N<2)
+    return 0;
+
+  N        = (double) running->N;
+  distance = 0;
+
+  for (k=0; k<running->n; k++)
+    distance += 2*(double) running->count1[k]*(N-running->count1[k]);
+
+  return distance/(N*(N-1));
+}
+
+// ================================================================================
+//
+// name:          addChanges
+//
+// function:      adds the 1's and the optima of the new strings to the counts
+//                and takes those of the replaced ones away (on all threads, each
+//                one into its own counts, which are added up at the end)
+//
+// parameters:    running......the statistics
+//                added........the new strings
+//                replaced.....the population with the replaced strings (NULL
+//                             if none)
+//                slot.........where in it each new string goes
+//                M............the number of the new strings
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int addChanges(RunningStatistics *running, Population *added, Population *replaced, long *slot, long M)
+{
+  int  t,k;
+  long grain;
+  RunningTask task;
+
+  task.running    = running;
+  task.added      = added;
+  task.replaced   = replaced;
+  task.slot       = slot;
+
+  memset(running->delta,0,(long) getNumThreads()*running->n*sizeof(long));
+  memset(running->deltaOptimal,0,getNumThreads()*sizeof(long));
+
+  grain = M/(getNumThreads()*RUNNING_CHUNKS_PER_THREAD);
+
+  parallelFor(M,grain,&countChanges,&task);
+
+  for (t=0; t<getNumThreads(); t++)
+    {
+      for (k=0; k<running->n; k++)
+	running->count1[k] += running->delta[(long) t*running->n+k];
+
+      running->numOptimal += running->deltaOptimal[t];
+    }
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          countChanges
+//
+// function:      the parallel task counting the changes of the strings
+//                first...last-1
+//
+// parameters:    first........the first string
+//                last.........one past the last string
+//                thread.......the thread running the task
+//                data.........the task (RunningTask)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int countChanges(long first, long last, int thread, void *data)
+{
+  long j;
+  int  k,n;
+  long *delta;
+  char *x,*y;
+  RunningTask *task;
+
+  task  = (RunningTask*) data;
+  n     = task->running->n;
+  delta = task->running->delta+(long) thread*n;
+
+  for (j=first; j<last; j++)
+    {
+      x = task->added->x[j];
+
+      if (task->replaced!=NULL)
+	{
+	  y = task->replaced->x[task->slot[j]];
+
+	  for (k=0; k<n; k++)
+	    delta[k] += x[k]-y[k];
+	}
+      else
+	for (k=0; k<n; k++)
+	  delta[k] += x[k];
+
+      if (isBestDefined())
+	{
+	  if (isOptimal(x,n))
+	    task->running->deltaOptimal[thread]++;
+	  if ((task->replaced!=NULL)&&(isOptimal(task->replaced->x[task->slot[j]],n)))
+	    task->running->deltaOptimal[thread]--;
+	}
+    }
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          listNodes
+//
+// function:      lists the strings of the ranks first...first+count-1 of a subtree
+//                (the subtrees entirely out of the range are skipped)
+//
+// parameters:    running......the statistics
+//                x............the root of the subtree
+//                first........the first rank (in the subtree)
+//                count........the number of the strings to list
+//                individual...the positions of the strings (output)
+//
+// returns:       (long) the number of the listed strings
+//
+// ================================================================================
+
+static long listNodes(RunningStatistics *running, long x, long first, long count, long *individual)
+{
+  long leftSize;
+  long listed;
+
+  if ((x<0)||(count<=0))
+    return 0;
+
+  leftSize = (running->left[x]>=0)? running->size[running->left[x]]:0;
+  listed   = 0;
+
+  if (first<leftSize)
+    listed = listNodes(running,running->left[x],first,count,individual);
+
+  if ((first<=leftSize)&&(listed<count))
+    individual[listed++] = x;
+
+  if (listed<count)
+    listed += listNodes(running,running->right[x],(first>leftSize+1)? first-leftSize-1:0,count-listed,individual+listed);
+
+  return listed;
+}
+
+// ================================================================================
+//
+// name:          nodeBefore
+//
+// function:      compares two strings in the tree (the worse one goes first, the
+//                later one of the same fitness goes first)
+//
+// parameters:    running......the statistics
+//                a............the first string
+//                b............the second string
+//
+// returns:       (int) 1 if the first string goes before the second, 0 otherwise
+//
+// ================================================================================
+
+static int nodeBefore(RunningStatistics *running, long a, long b)
+{
+  if (running->f[a]!=running->f[b])
+    return (running->f[a]<running->f[b]);
+
+  return (a>b);
+}
+
+// ================================================================================
+//
+// name:          updateSize
+//
+// function:      recomputes the size of a subtree from its children
+//
+// parameters:    running......the statistics
+//                x............the root of the subtree
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int updateSize(RunningStatistics *running, long x)
+{
+  running->size[x] = 1;
+
+  if (running->left[x]>=0)
+    running->size[x] += running->size[running->left[x]];
+  if (running->right[x]>=0)
+    running->size[x] += running->size[running->right[x]];
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          insertNode
+//
+// function:      inserts a string into a subtree
+//
+// parameters:    running......the statistics
+//                root.........the root of the subtree (-1 if empty)
+//                x............the string
+//
+// returns:       (long) the new root of the subtree
+//
+// ================================================================================
+
+static long insertNode(RunningStatistics *running, long root, long x)
+{
+  long child;
+
+  if (root<0)
+    {
+      running->left[x] = running->right[x] = -1;
+      running->size[x] = 1;
+      return x;
+    }
+
+  if (nodeBefore(running,x,root))
+    {
+      child = running->left[root] = insertNode(running,running->left[root],x);
+
+      // rotate right if the child should be above
+
+      if (running->priority[child]>running->priority[root])
+	{
+	  running->left[root]   = running->right[child];
+	  running->right[child] = root;
+	  updateSize(running,root);
+	  updateSize(running,child);
+	  return child;
+	}
+    }
+  else
+    {
+      child = running->right[root] = insertNode(running,running->right[root],x);
+
+      // rotate left if the child should be above
+
+      if (running->priority[child]>running->priority[root])
+	{
+	  running->right[root] = running->left[child];
+	  running->left[child] = root;
+	  updateSize(running,root);
+	  updateSize(running,child);
+	  return child;
+	}
+    }
+
+  updateSize(running,root);
+
+  return root;
+}
+
+// ================================================================================
+//
+// name:          removeNode
+//
+// function:      removes a string from a subtree
+//
+// parameters:    running......the statistics
+//                root.........the root of the subtree
+//                x............the string
+//
+// returns:       (long) the new root of the subtree
+//
+// ================================================================================
+
+static long removeNode(RunningStatistics *running, long root, long x)
+{
+  if (root==x)
+    return mergeNodes(running,running->left[x],running->right[x]);
+
+  if (nodeBefore(running,x,root))
+    running->left[root] = removeNode(running,running->left[root],x);
+  else
+    running->right[root] = removeNode(running,running->right[root],x);
+
+  updateSize(running,root);
+
+  return root;
+}
+
+// ================================================================================
+//
+// name:          mergeNodes
+//
+// function:      merges two subtrees (all the strings of the first one go before
+//                those of the second one)
+//
+// parameters:    running......the statistics
+//                a............the root of the first subtree (-1 if empty)
+//                b............the root of the second subtree (-1 if empty)
+//
+// returns:       (long) the root of the merged tree
+//
+// ================================================================================
+
+static long mergeNodes(RunningStatistics *running, long a, long b)
+{
+  if (a<0)
+    return b;
+  if (b<0)
+    return a;
+
+  if (running->priority[a]>running->priority[b])
+    {
+      running->right[a] = mergeNodes(running,running->right[a],b);
+      updateSize(running,a);
+      return a;
+    }
+  else
+    {
+      running->left[b] = mergeNodes(running,a,running->left[b]);
+      updateSize(running,b);
+      return b;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef _runningStatistics_h_
+#define _runningStatistics_h_
+
+#include <stdint.h>
+
+#include "population.h"
+
+// ---------------------------------------------------------------------
+// the statistics of a population kept up to date as the strings are
+// replaced (the counts of 1's, the sum of the fitness values, the number
+// of optima, and the fitness values in an order statistic tree, which is
+// a treap with a node for each string of the population)
+// ---------------------------------------------------------------------
+
+typedef struct {
+
+  long     N;
+  int      n;
+
+  long     *count1;      // the number of 1's on each position
+  double   sumF;         // the sum of the fitness values
+  long     numOptimal;   // the number of optima
+
+  float    *f;           // the fitness of each string (the key of its node)
+  long     *left;
+  long     *right;
+  long     *size;        // the number of nodes in each subtree
+  uint32_t *priority;
+  long     root;
+
+  long     *delta;       // the changes of the counts of each thread
+  long     *deltaOptimal;
+
+} RunningStatistics;
+
+int initializeRunningStatistics(RunningStatistics *running, Population *population);
+int doneRunningStatistics(RunningStatistics *running);
+int updateRunningStatistics(RunningStatistics *running,
+			    Population *population,
+			    Population *offspring,
+			    long *slot,
+			    long M);
+
+long getWorstIndividual(RunningStatistics *running);
+long getBestIndividual(RunningStatistics *running);
+long getRankedIndividual(RunningStatistics *running, long rank);
+long listRankedIndividuals(RunningStatistics *running, long first, long count, long *individual);
+long countWorseThan(RunningStatistics *running, float f);
+long countNotBetterThan(RunningStatistics *running, float f);
+
+double getBitEntropy(RunningStatistics *running, int k);
+double getPopulationEntropy(RunningStatistics *running);
+double getPopulationDiversity(RunningStatistics *running);
+
+#endif
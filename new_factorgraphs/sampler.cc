@@ -0,0 +1,294 @@
+// ################################################################################
+//
+// name:          sampler.cc
+//
+// purpose:       the decision graphs of a network compiled into a flat array of
+//                nodes (with the probabilities of the leaves precomputed), so that
+//                the new instances are generated without chasing the pointers of
+//                the graphs; the instances are generated in blocks, each with its
+//                own random stream, on all threads
+//
+// ################################################################################
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sampler.h"
+#include "bayesian.h"
+#include "labeledTreeNode.h"
+#include "memalloc.h"
+#include "random.h"
+#include "threadPool.h"
+
+// ---------------------------------------------------------------------
+// the number of instances in a block (each block has got its own random
+// stream, so the instances don't depend on the number of threads)
+// ---------------------------------------------------------------------
+
+#define SAMPLER_BLOCK_SIZE 256
+
+// -----------------------------------------------
+// the blocks of instances generated by the threads
+// -----------------------------------------------
+
+typedef struct {
+  Sampler    *sampler;
+  Population *P;
+} SamplerTask;
+
+static int numberNodes(LabeledTreeNode *x, LabeledTreeNode ***list, long *numNodes, long *listSize);
+static int sampleBlocks(long first, long last, int thread, void *data);
+
+// ================================================================================
+//
+// name:          compileSampler
+//
+// function:      compiles the decision graphs of a network into a sampler; the
+//                nodes of each graph are put one after another, each node before
+//                its children (the nodes shared by more parents only once)
+//
+// parameters:    sampler......the sampler (output)
+//                G............the network
+//                T............the decision graphs for each variable
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int compileSampler(Sampler *sampler, AcyclicOrientedGraph *G, FrequencyDecisionGraph **T)
+{
+  int  k;
+  int  n;
+  long j;
+  long listSize;
+  LabeledTreeNode **list;
+  LabeledTreeNode *x;
+  SamplerNode *node;
+  double p0;
+
+  n = G->size();
+
+  sampler->n     = n;
+  sampler->order = (int*) Calloc(n,sizeof(int));
+  sampler->root  = (int32_t*) Calloc(n,sizeof(int32_t));
+
+  // order the vertices topologically
+
+  topologicalOrdering(G,sampler->order);
+
+  // number the nodes of all the graphs
+
+  listSize          = 1024;
+  list              = (LabeledTreeNode**) Calloc(listSize,sizeof(LabeledTreeNode*));
+  sampler->numNodes = 0;
+
+  for (k=0; k<n; k++)
+    {
+      sampler->root[sampler->order[k]] = sampler->numNodes;
+      numberNodes(T[sampler->order[k]]->getRoot(),&list,&(sampler->numNodes),&listSize);
+    }
+
+  // and put them in the array
+
+  sampler->node = (SamplerNode*) Calloc(sampler->numNodes,sizeof(SamplerNode));
+
+  for (j=0; j<sampler->numNodes; j++)
+    {
+      x    = list[j];
+      node = &(sampler->node[j]);
+
+      if (x->which==LEAF)
+	{
+	  // the probability of 1 the same way it's always been computed
+
+	  p0 = x->value[0]/(x->value[0]+x->value[1]);
+
+	  node->label = -1;
+	  node->left  = node->right = -1;
+	  node->p1    = 1-p0;
+	}
+      else
+	{
+	  node->label = x->label;
+	  node->left  = x->left->samplerIndex;
+	  node->right = x->right->samplerIndex;
+	  node->p1    = 0;
+	}
+    }
+
+  Free(list);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          freeSampler
+//
+// function:      frees the memory used by a sampler
+//
+// parameters:    sampler......the sampler
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int freeSampler(Sampler *sampler)
+{
+  Free(sampler->order);
+  Free(sampler->root);
+  Free(sampler->node);
+
+  sampler->order    = NULL;
+  sampler->root     = NULL;
+  sampler->node     = NULL;
+  sampler->numNodes = 0;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          sampleInstances
+//
+// function:      generates all the strings of a population with the sampler
+//
+// parameters:    sampler......the sampler
+//                P............the population to store the new instances in
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int sampleInstances(Sampler *sampler, Population *P)
+{
+  long numBlocks;
+  SamplerTask task;
+
+  numBlocks = (P->N+SAMPLER_BLOCK_SIZE-1)/SAMPLER_BLOCK_SIZE;
+
+  task.sampler = sampler;
+  task.P       = P;
+
+  // generate the blocks
+
+  parallelFor(numBlocks,1,&sampleBlocks,&task);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          numberNodes
+//
+// function:      numbers the nodes of a graph that have not been numbered yet,
+//                each node before its children, and lists them
+//
+// parameters:    x............the node to start in
+//                list.........the list of the numbered nodes (it grows as needed)
+//                numNodes.....the number of the numbered nodes
+//                listSize.....how many nodes fit in the list
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int numberNodes(LabeledTreeNode *x, LabeledTreeNode ***list, long *numNodes, long *listSize)
+{
+  if (x->samplerIndex>=0)
+    return 0;
+
+  if (*numNodes==*listSize)
+    {
+      *listSize *= 2;
+      *list      = (LabeledTreeNode**) Realloc(*list,*listSize,sizeof(LabeledTreeNode*));
+    }
+
+  x->samplerIndex       = *numNodes;
+  (*list)[(*numNodes)++] = x;
+
+  if (x->which!=LEAF)
+    {
+      numberNodes(x->left,list,numNodes,listSize);
+      numberNodes(x->right,list,numNodes,listSize);
+    }
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          sampleBlocks
+//
+// function:      the parallel task generating the blocks first...last-1; a block is
+//                done a variable at a time (so that the nodes of its graph stay in
+//                the cache for all the instances of the block), with the random
+//                numbers for the variable generated all at once
+//
+// parameters:    first........the first block
+//                last.........one past the last block
+//                thread.......the thread running the task (unused)
+//                data.........the task (SamplerTask)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int sampleBlocks(long first, long last, int thread, void *data)
+{
+  SamplerTask *task;
+  SamplerNode *node;
+  int  k;
+  int  position;
+  long b,i;
+  long firstInstance,lastInstance;
+  RandomStream stream;
+  double u[SAMPLER_BLOCK_SIZE];
+  int32_t j;
+  char *x;
+
+  task = (SamplerTask*) data;
+  node = task->sampler->node;
+
+  for (b=first; b<last; b++)
+    {
+      firstInstance = b*SAMPLER_BLOCK_SIZE;
+      lastInstance  = firstInstance+SAMPLER_BLOCK_SIZE;
+      if (lastInstance>task->P->N)
+	lastInstance = task->P->N;
+
+      initializeStream(&stream,RANDOM_PHASE_SAMPLING,b);
+
+      for (k=0; k<task->sampler->n; k++)
+	{
+	  position = task->sampler->order[k];
+
+	  fillUniform(&stream,u,lastInstance-firstInstance);
+
+	  for (i=firstInstance; i<lastInstance; i++)
+	    {
+	      x = task->P->x[i];
+
+	      // follow the instance down to a leaf
+
+	      j = task->sampler->root[position];
+	      while (node[j].label>=0)
+		j = (x[node[j].label])? node[j].right:node[j].left;
+
+	      x[position] = (u[i-firstInstance]<node[j].p1)? 1:0;
+	    }
+	}
+    }
+
+  // get back
+
+  return 0;
+}
@@ -0,0 +1,41 @@
+#ifndef _sampler_h_
+#define _sampler_h_
+
+#include <stdint.h>
+
+#include "graph.h"
+#include "frequencyDecisionGraph.h"
+#include "population.h"
+
+// ---------------------------------------------------------------------
+// a node of a compiled decision graph; an inner node goes to its left
+// child if the label is 0 and to its right child otherwise, a leaf (label
+// -1) generates 1 with probability p1
+// ---------------------------------------------------------------------
+
+struct SamplerNode {
+  int32_t label;
+  int32_t left;
+  int32_t right;
+  double  p1;
+};
+
+// ---------------------------------------------------------------------
+// the decision graphs of a network compiled into one array, the graphs of
+// the variables in topological order, each one from its root
+// ---------------------------------------------------------------------
+
+struct Sampler {
+  int         n;
+  int         *order;      // the variables in topological order
+  int32_t     *root;       // the root of the graph of each variable
+  SamplerNode *node;
+  long        numNodes;
+};
+
+int compileSampler(Sampler *sampler, AcyclicOrientedGraph *G, FrequencyDecisionGraph **T);
+int freeSampler(Sampler *sampler);
+
+int sampleInstances(Sampler *sampler, Population *P);
+
+#endif
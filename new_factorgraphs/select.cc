@@ -14,15 +14,36 @@
 #include "population.h"
 #include "select.h"
 #include "random.h"
+#include "threadPool.h"
+
+// ---------------------------------------------------------------
+// how many chunks per thread the tournaments are cut into
+// ---------------------------------------------------------------
+
+#define SELECTION_CHUNKS_PER_THREAD 16
+
+// ---------------------------------------------------------------
+// the tournaments done by the threads
+// ---------------------------------------------------------------
+
+typedef struct {
+  Population *population;
+  Population *parents;
+  int        tournamentSize;
+} SelectionTask;
+
+static int performTournaments(long first, long last, int thread, void *data);
 
 // ================================================================================
 //
 // name:          selectTheBest
 //
-// function:      performs tournament selection (realizing tournaments on the guys)
+// function:      performs tournament selection (realizing tournaments on the guys,
+//                spread over the threads of the thread pool)
 //
 // parameters:    population...the population where to select from
-//                parents......the population where to put the selected to
+//                parents......the view where to put the selected to (pointing at
+//                             the strings of the population)
 //                params.......the parameters passed to the BOA
 //
 // returns:       (int) 0
@@ -31,27 +52,73 @@
 
 int selectTheBest(Population *population, Population *parents, BoaParams *params)
 {
-  register long i,j;
+  long grain;
+  SelectionTask task;
+
+  task.population     = population;
+  task.parents        = parents;
+  task.tournamentSize = params->tournamentSize;
+
+  // cut the tournaments into chunks
+
+  grain = population->N/(getNumThreads()*SELECTION_CHUNKS_PER_THREAD);
+
+  // perform them
+
+  parallelFor(population->N,grain,&performTournaments,&task);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          performTournaments
+//
+// function:      performs the tournaments first...last-1 (each one with a random
+//                stream of its own, so it doesn't matter which thread does it)
+//
+// parameters:    first........the first tournament
+//                last.........one past the last tournament
+//                thread.......the thread running the task (unused)
+//                data.........the task (SelectionTask)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int performTournaments(long first, long last, int thread, void *data)
+{
+  long i,j;
   long N;
   long picked;
   long max;
   double maxF;
+  RandomStream stream;
+  SelectionTask *task;
+  Population *population;
+
+  task       = (SelectionTask*) data;
+  population = task->population;
 
   // initialize some variables
 
   N = population->N;
 
-  for (i=0; i<N; i++)
+  for (i=first; i<last; i++)
     {
       // perform a tournament
 
-      picked = longRand(N);
+      initializeStream(&stream,RANDOM_PHASE_SELECTION,i);
+
+      picked = longRandStream(&stream,N);
       maxF   = population->f[picked];
       max    = picked;
 
-      for (j=1; j<params->tournamentSize; j++)
+      for (j=1; j<task->tournamentSize; j++)
 	{
-	  picked = longRand(N);
+	  picked = longRandStream(&stream,N);
 	  if (population->f[picked]>maxF)
 	    {
 	      maxF = population->f[picked];
@@ -61,9 +128,10 @@ int selectTheBest(Population *population, Population *parents, BoaParams *params
 
       picked=max;
 
-      // insert the picked guy into the selected population
+      // point the selected population at the picked guy (no copying)
       
-      copyIndividual(parents,i,population->x[picked],population->f[picked]);
+      task->parents->x[i] = population->x[picked];
+      task->parents->f[i] = population->f[picked];
     };
 
   // get back
@@ -22,6 +22,8 @@
 #include "memalloc.h"
 #include "graph.h"
 #include "frequencyDecisionGraph.h"
+#include "fitnessCache.h"
+#include "bayesian.h"
 
 // ================================================================================
 //
@@ -75,19 +77,21 @@ int doneBasicStatistics(BasicStatistics *statistics)
 //
 // function:      computes some basic statistics (on fitness and so) and sets some
 //                variables required for printing this information out in the
-//                future
+//                future (all taken from the statistics the replacement keeps up
+//                to date)
 //
 // parameters:    t............number of generation
 //                population...a current population
+//                running......the statistics of the population
 //                boaParams....the parameters sent to the BOA
 //
 // returns:       (int) 0
 //
 // ================================================================================
 
-int computeBasicStatistics(BasicStatistics *statistics, long t, Population *population, BoaParams *boaParams)
+int computeBasicStatistics(BasicStatistics *statistics, long t, Population *population, RunningStatistics *running, BoaParams *boaParams)
 {
-  long i;
+  int k;
 
   // set some variables
 
@@ -96,36 +100,21 @@ int computeBasicStatistics(BasicStatistics *statistics, long t, Population *popu
   statistics->generation        = t;
   statistics->guidanceThreshold = boaParams->guidanceThreshold;
 
-  // compute the maximal, minimal and average fitness in the population
+  // the maximal, minimal and average fitness in the population
 
-  statistics->max = 0;
-  statistics->minF = statistics->maxF = statistics->avgF = population->f[0];
-  if (isBestDefined())
-    statistics->numOptimal = (isOptimal(population->x[0],statistics->n))? 1:0;
+  statistics->max        = getBestIndividual(running);
+  statistics->maxF       = population->f[statistics->max];
+  statistics->minF       = population->f[getWorstIndividual(running)];
+  statistics->avgF       = running->sumF/(double) statistics->N;
+  statistics->numOptimal = running->numOptimal;
 
-  for (i=1; i<statistics->N; i++)
-    {
-      statistics->avgF += population->f[i];
+  // the univariate frequencies, the entropy and the diversity
 
-      if (population->f[i]<statistics->minF)
-	statistics->minF = population->f[i];
-      else
-	if (population->f[i]>statistics->maxF)
-	  {
-	    statistics->maxF = population->f[i];
-	    statistics->max = i;
-	  }
-
-      if (isBestDefined())
-	if (isOptimal(population->x[i],statistics->n))
-	  statistics->numOptimal++;
-    };
+  for (k=0; k<statistics->n; k++)
+    statistics->p1[k] = (float) running->count1[k]/(float) statistics->N;
 
-  statistics->avgF /= (double) statistics->N;
-
-  // allocate memory for and compute the univariate frequencies
-
-  computeUnivariateFrequencies(population,statistics->p1);
+  statistics->entropy   = getPopulationEntropy(running);
+  statistics->diversity = getPopulationDiversity(running);
 
   // set the best guy (if defined...)
 
@@ -161,9 +150,17 @@ int generationStatistics(FILE *out, BasicStatistics *statistics)
   fprintf(out,"--------------------------------------------------------\n");
   fprintf(out,"Generation                   : %lu\n",statistics->generation);
   fprintf(out,"Fitness evaluations          : %lu\n",getFitnessCalls());
+  if (isFitnessCacheOn())
+    {
+      fprintf(out,"Fitness computations         : %lu\n",getFitnessComputations());
+      fprintf(out,"Fitness cache (hits/misses)  : (%lu %lu)\n",getFitnessCacheHits(),getFitnessCacheMisses());
+    }
+  fprintf(out,"Model memory (peak)          : %.2f MB\n",getModelMemoryPeak()/1048576.0);
+  fprintf(out,"Model building (rounds/ops)  : (%lu %lu)\n",getModelBuildRounds(),getModelBuildOperators());
   fprintf(out,"Fitness (max/avg/min)        : (%5f %5f %5f)\n",statistics->maxF,statistics->avgF,statistics->minF);
   if (isBestDefined())
     fprintf(out,"Percentage of optima in pop. : %1.2f\n",((float)statistics->numOptimal/(float)statistics->N)*100);
+  fprintf(out,"Diversity (entropy/distance) : (%5f %5f)\n",statistics->entropy,statistics->diversity);
   fprintf(out,"Population bias              : ");
   printGuidance(out,statistics->p1,statistics->n,statistics->guidanceThreshold);
   fprintf(out,"\n");
@@ -234,6 +231,13 @@ int finalStatistics(FILE *out, char *termination, BasicStatistics *statistics)
   fprintf(out, "Termination reason           : %s\n",termination);
   fprintf(out, "Generations performed        : %lu\n",statistics->generation);
   fprintf(out, "Fitness evaluations          : %lu\n",getFitnessCalls());
+  if (isFitnessCacheOn())
+    {
+      fprintf(out, "Fitness computations         : %lu\n",getFitnessComputations());
+      fprintf(out, "Fitness cache (hits/misses)  : (%lu %lu)\n",getFitnessCacheHits(),getFitnessCacheMisses());
+    }
+  fprintf(out, "Model memory (peak)          : %.2f MB\n",getModelMemoryPeak()/1048576.0);
+  fprintf(out, "Model building (rounds/ops)  : (%lu %lu)\n",getModelBuildRounds(),getModelBuildOperators());
   fprintf(out, "Fitness (max/avg/min)        : (%5f %5f %5f)\n",statistics->maxF,statistics->avgF,statistics->minF);
   if (isBestDefined())
     fprintf(out, "Percentage of optima in pop. : %1.2f\n",((float)statistics->numOptimal/(float)statistics->N)*100);
@@ -4,6 +4,7 @@
 #include <stdio.h>
 
 #include "population.h"
+#include "runningStatistics.h"
 #include "boa.h"
 #include "graph.h"
 #include "frequencyDecisionGraph.h"
@@ -22,6 +23,8 @@ typedef struct {
   long   numOptimal;       // number of optimal solutions
   long   max;              // number of maximal individual
   float  *p1;              // univariate frequencies
+  double entropy;          // average entropy of the positions
+  double diversity;        // average distance of two strings
   char   *bestX;           // best guy
   float guidanceThreshold; // guidance threshold
 
@@ -29,7 +32,7 @@ typedef struct {
 
 int intializeBasicStatistics(BasicStatistics *statistics, BoaParams *boaParams);
 int doneBasicStatistics(BasicStatistics *statistics);
-int computeBasicStatistics(BasicStatistics *statistics, long t, Population *population, BoaParams *boaParams);
+int computeBasicStatistics(BasicStatistics *statistics, long t, Population *population, RunningStatistics *running, BoaParams *boaParams);
 
 int generationStatistics(FILE *out, BasicStatistics *statistics);
 int fitnessStatistics(FILE *out, BasicStatistics *statistics);
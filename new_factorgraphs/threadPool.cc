@@ -0,0 +1,440 @@
+// ################################################################################
+//
+// name:          threadPool.cc
+//
+// purpose:       a pool of worker threads running parallel loops; the loop is cut
+//                into chunks, each thread gets a deque of chunks it works off from
+//                one end while idle threads steal from the other end
+//
+// ################################################################################
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "threadPool.h"
+#include "memalloc.h"
+
+// -------------------------------------
+// a chunk of a loop and a deque of them
+// -------------------------------------
+
+typedef struct {
+  long         first;
+  long         last;
+  ParallelTask *task;
+  void         *data;
+} Chunk;
+
+typedef struct {
+  pthread_mutex_t lock;
+  Chunk           *chunk;
+  long            head;      // first chunk left (stolen by the others)
+  long            tail;      // one past the last chunk left (taken by the owner)
+  long            capacity;
+} ChunkDeque;
+
+// ---------------
+// the pool itself
+// ---------------
+
+static int             numThreads_=1;
+static pthread_t       *workers=NULL;
+static ChunkDeque      *deques=NULL;
+
+static pthread_mutex_t poolLock;
+static pthread_cond_t  workAvailable;
+static pthread_cond_t  workDone;
+static long            jobNumber;
+static volatile long   chunksPending;
+static char            shuttingDown;
+
+static void *workerMain(void *arg);
+static int  takeOwnChunk(int thread, Chunk *c);
+static int  stealChunk(int thread, Chunk *c);
+static int  runChunks(int thread);
+
+// ================================================================================
+//
+// name:          initializeThreadPool
+//
+// function:      starts the worker threads (the calling thread is used as well, so
+//                numThreads-1 threads are started)
+//
+// parameters:    numThreads...the number of threads to use (0 or less means one per
+//                             online processor)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int initializeThreadPool(int numThreads)
+{
+  int i;
+
+  // how many?
+
+  if (numThreads<=0)
+    numThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (numThreads<1)
+    numThreads = 1;
+
+  numThreads_ = numThreads;
+
+  // allocate the deques (one per thread)
+
+  deques = (ChunkDeque*) Calloc(numThreads_,sizeof(ChunkDeque));
+  for (i=0; i<numThreads_; i++)
+    {
+      pthread_mutex_init(&(deques[i].lock),NULL);
+      deques[i].chunk    = NULL;
+      deques[i].head     = deques[i].tail = 0;
+      deques[i].capacity = 0;
+    }
+
+  // nothing to do yet
+
+  pthread_mutex_init(&poolLock,NULL);
+  pthread_cond_init(&workAvailable,NULL);
+  pthread_cond_init(&workDone,NULL);
+
+  jobNumber     = 0;
+  chunksPending = 0;
+  shuttingDown  = 0;
+
+  // start the workers
+
+  if (numThreads_>1)
+    {
+      workers = (pthread_t*) Calloc(numThreads_,sizeof(pthread_t));
+
+      for (i=1; i<numThreads_; i++)
+	if (pthread_create(&(workers[i]),NULL,&workerMain,(void*)(long) i))
+	  {
+	    fprintf(stderr,"ERROR: Cannot start a worker thread!\n");
+	    exit(-1);
+	  }
+    }
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          doneThreadPool
+//
+// function:      stops the worker threads and frees the pool
+//
+// parameters:    (none)
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int doneThreadPool()
+{
+  int i;
+
+  // tell the workers to quit and wait for them
+
+  if (workers)
+    {
+      pthread_mutex_lock(&poolLock);
+      shuttingDown = 1;
+      pthread_cond_broadcast(&workAvailable);
+      pthread_mutex_unlock(&poolLock);
+
+      for (i=1; i<numThreads_; i++)
+	pthread_join(workers[i],NULL);
+
+      Free(workers);
+      workers = NULL;
+    }
+
+  // free the deques
+
+  if (deques)
+    {
+      for (i=0; i<numThreads_; i++)
+	{
+	  pthread_mutex_destroy(&(deques[i].lock));
+	  if (deques[i].chunk)
+	    Free(deques[i].chunk);
+	}
+
+      Free(deques);
+      deques = NULL;
+    }
+
+  pthread_mutex_destroy(&poolLock);
+  pthread_cond_destroy(&workAvailable);
+  pthread_cond_destroy(&workDone);
+
+  numThreads_ = 1;
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          getNumThreads
+//
+// function:      returns the number of threads of the pool (including the calling
+//                thread)
+//
+// parameters:    (none)
+//
+// returns:       (int) the number of threads
+//
+// ================================================================================
+
+int getNumThreads()
+{
+  return numThreads_;
+}
+
+// ================================================================================
+//
+// name:          parallelFor
+//
+// function:      runs a task over the items 0...N-1 on all threads of the pool and
+//                waits until it is done; the items are cut into chunks of grain
+//                items, consecutive chunks are handed to the same thread
+//
+// parameters:    N............the number of items
+//                grain........the number of items in a chunk
+//                task.........the task to run on each chunk
+//                data.........the data passed to the task
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+int parallelFor(long N, long grain, ParallelTask *task, void *data)
+{
+  long numChunks;
+  long k,first,last;
+  int  i;
+
+  // nothing to do?
+
+  if (N<=0)
+    return 0;
+
+  // no pool, do it right here
+
+  if ((numThreads_==1)||(deques==NULL))
+    {
+      task(0,N,0,data);
+      return 0;
+    }
+
+  if (grain<1)
+    grain = 1;
+
+  numChunks = (N+grain-1)/grain;
+
+  // all the chunks are pending (set before anyone can see them)
+
+  chunksPending = numChunks;
+
+  // give each thread a block of consecutive chunks
+
+  for (i=0; i<numThreads_; i++)
+    {
+      first = (numChunks*i)/numThreads_;
+      last  = (numChunks*(i+1))/numThreads_;
+
+      pthread_mutex_lock(&(deques[i].lock));
+
+      if (deques[i].capacity<last-first)
+	{
+	  deques[i].capacity = last-first;
+	  deques[i].chunk    = (Chunk*) Realloc(deques[i].chunk,deques[i].capacity,sizeof(Chunk));
+	}
+
+      for (k=first; k<last; k++)
+	{
+	  deques[i].chunk[k-first].first = k*grain;
+	  deques[i].chunk[k-first].last  = ((k+1)*grain<N)? (k+1)*grain:N;
+	  deques[i].chunk[k-first].task  = task;
+	  deques[i].chunk[k-first].data  = data;
+	}
+
+      deques[i].head = 0;
+      deques[i].tail = last-first;
+
+      pthread_mutex_unlock(&(deques[i].lock));
+    }
+
+  // wake up the workers
+
+  pthread_mutex_lock(&poolLock);
+  jobNumber++;
+  pthread_cond_broadcast(&workAvailable);
+  pthread_mutex_unlock(&poolLock);
+
+  // work as well
+
+  runChunks(0);
+
+  // wait for the others to finish
+
+  pthread_mutex_lock(&poolLock);
+  while (chunksPending>0)
+    pthread_cond_wait(&workDone,&poolLock);
+  pthread_mutex_unlock(&poolLock);
+
+  // get back
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          workerMain
+//
+// function:      the main loop of a worker thread (sleeps until there's some work)
+//
+// parameters:    arg..........the number of the thread
+//
+// returns:       (void*) NULL
+//
+// ================================================================================
+
+static void *workerMain(void *arg)
+{
+  int  thread;
+  long seen;
+
+  thread = (int)(long) arg;
+  seen   = 0;
+
+  pthread_mutex_lock(&poolLock);
+
+  for (;;)
+    {
+      while ((!shuttingDown)&&(jobNumber==seen))
+	pthread_cond_wait(&workAvailable,&poolLock);
+
+      if (shuttingDown)
+	break;
+
+      seen = jobNumber;
+
+      pthread_mutex_unlock(&poolLock);
+      runChunks(thread);
+      pthread_mutex_lock(&poolLock);
+    }
+
+  pthread_mutex_unlock(&poolLock);
+
+  return NULL;
+}
+
+// ================================================================================
+//
+// name:          takeOwnChunk
+//
+// function:      takes the last chunk from a thread's own deque
+//
+// parameters:    thread.......the thread
+//                c............where to put the chunk
+//
+// returns:       (int) 1 if a chunk was taken, 0 if the deque is empty
+//
+// ================================================================================
+
+static int takeOwnChunk(int thread, Chunk *c)
+{
+  int taken;
+  ChunkDeque *d;
+
+  d = &(deques[thread]);
+
+  pthread_mutex_lock(&(d->lock));
+  taken = (d->head<d->tail);
+  if (taken)
+    *c = d->chunk[--d->tail];
+  pthread_mutex_unlock(&(d->lock));
+
+  return taken;
+}
+
+// ================================================================================
+//
+// name:          stealChunk
+//
+// function:      steals the first chunk from the deque of some other thread
+//
+// parameters:    thread.......the thread that steals
+//                c............where to put the chunk
+//
+// returns:       (int) 1 if a chunk was stolen, 0 if all the deques are empty
+//
+// ================================================================================
+
+static int stealChunk(int thread, Chunk *c)
+{
+  int i;
+  int victim;
+  int taken;
+  ChunkDeque *d;
+
+  for (i=1; i<numThreads_; i++)
+    {
+      victim = (thread+i)%numThreads_;
+      d      = &(deques[victim]);
+
+      pthread_mutex_lock(&(d->lock));
+      taken = (d->head<d->tail);
+      if (taken)
+	*c = d->chunk[d->head++];
+      pthread_mutex_unlock(&(d->lock));
+
+      if (taken)
+	return 1;
+    }
+
+  return 0;
+}
+
+// ================================================================================
+//
+// name:          runChunks
+//
+// function:      runs chunks (own ones first, then stolen ones) until there are none
+//                left
+//
+// parameters:    thread.......the thread
+//
+// returns:       (int) 0
+//
+// ================================================================================
+
+static int runChunks(int thread)
+{
+  Chunk c;
+
+  while ((takeOwnChunk(thread,&c))||(stealChunk(thread,&c)))
+    {
+      c.task(c.first,c.last,thread,c.data);
+
+      // the last one wakes up whoever waits for the loop to finish
+
+      if (__sync_sub_and_fetch(&chunksPending,1)==0)
+	{
+	  pthread_mutex_lock(&poolLock);
+	  pthread_cond_broadcast(&workDone);
+	  pthread_mutex_unlock(&poolLock);
+	}
+    }
+
+  return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef _threadPool_h_
+#define _threadPool_h_
+
+// a task processes the items first...last-1 of a parallel loop; thread is the
+// number of the thread running it (0 is the calling thread)
+
+typedef int ParallelTask(long first, long last, int thread, void *data);
+
+int initializeThreadPool(int numThreads);
+int doneThreadPool();
+int getNumThreads();
+
+int parallelFor(long N, long grain, ParallelTask *task, void *data);
+
+#endif